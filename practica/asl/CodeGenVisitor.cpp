@@ -36,6 +36,7 @@
 #include "../common/code.h"
 
 #include <string>
+#include <utility>    // std::move
 #include <cstddef>    // std::size_t
 
 // uncomment the following line to enable debugging messages with DEBUG*
@@ -112,7 +113,7 @@ antlrcpp::Any CodeGenVisitor::visitFunction(AslParser::FunctionContext *ctx) {
   instructionList && code = visit(ctx->statements());
 
   //RETURN
-  if (not ctx->basic_type()) code = code || instruction(instruction::RETURN());
+  if (not ctx->basic_type()) code = std::move(code) || instruction(instruction::RETURN());
 
   subr.set_instructions(code);
   Symbols.popScope();
@@ -172,7 +173,7 @@ antlrcpp::Any CodeGenVisitor::visitStatements(AslParser::StatementsContext *ctx)
   instructionList code;
   for (auto stCtx : ctx->statement()) {
     instructionList && codeS = visit(stCtx);
-    code = code || codeS;
+    code = std::move(code) || std::move(codeS);
   }
   DEBUG_EXIT();
   return code;
@@ -195,9 +196,9 @@ antlrcpp::Any CodeGenVisitor::visitWhileStmt(AslParser::WhileStmtContext *ctx) {
 
   code = 
        instruction::LABEL(labelBeginWhile)
-    || codeExpr
+    || std::move(codeExpr)
     || instruction::FJUMP(addr1, labelEndWhile)
-    || codeStatements
+    || std::move(codeStatements)
     || instruction::UJUMP(labelBeginWhile)
     || instruction::LABEL(labelEndWhile);
 
@@ -221,7 +222,7 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
   TypesMgr::TypeId tid2 = getTypeDecor(ctx->expr());
 
   // code = code1 || code2 || instruction::LOAD(addr1, addr2);
-  code = code1 || code2;
+  code = std::move(code1) || std::move(code2);
 
   //Cas d'assignació d'arrays
   if(Types.isArrayTy(tid1) and Types.isArrayTy(tid2)) {
@@ -238,7 +239,7 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
 	  std::string labelEndWhile = "endwhile"+label;
 	  
     // CODE TO COPY EACH ELEMENT OF THE ARRAYS
-	  code = code
+	  code = std::move(code)
 		|| instruction::ILOAD(tempI,"0")
 		|| instruction::ILOAD(tempL,std::to_string(Types.getArraySize(tid1)))
 		|| instruction::ILOAD(tempINCR,"1")
@@ -258,17 +259,17 @@ antlrcpp::Any CodeGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx)
 	  std::string temp = "%"+codeCounters.newTEMP();
       
 	  if (Types.isFloatTy(tid1) and Types.isIntegerTy(tid2)) {
-		  code = code || instruction::FLOAT(temp,addr2);
+		  code = std::move(code) || instruction::FLOAT(temp,addr2);
 	  }
 	  else {
           temp = addr2; // if the float change is not
       }
 	  
 	  if (offs1 != "") {
-          code = code || instruction::XLOAD(addr1, offs1, temp);
+          code = std::move(code) || instruction::XLOAD(addr1, offs1, temp);
       }
 	  else {
-          code = code || instruction::LOAD(addr1, temp);
+          code = std::move(code) || instruction::LOAD(addr1, temp);
       }
   } 
 
@@ -294,18 +295,18 @@ antlrcpp::Any CodeGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
 	  // ELSE STATEMENT AND LABEL
 	  instructionList &&   codeSTMS2 = visit(ctx->statements(1));
 	  std::string labelElse = "else"+label;
-	  code = code1
+	  code = std::move(code1)
 		|| instruction::FJUMP(addr1, labelElse)
-		|| code2
+		|| std::move(code2)
 		|| instruction::UJUMP(labelEndIf)
 		|| instruction::LABEL(labelElse)
-		|| codeSTMS2
+		|| std::move(codeSTMS2)
 		|| instruction::LABEL(labelEndIf);
   }
   else {// NO ELSE CLAUSE
-	  code = code1
+	  code = std::move(code1)
 		|| instruction::FJUMP(addr1, labelEndIf)
-		|| code2
+		|| std::move(code2)
 		|| instruction::LABEL(labelEndIf);
   }
 
@@ -320,14 +321,14 @@ antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
   
   // PUSH SPACE FOR RETURN VALUE IF NON-VOID FUNCTION (even if result is not used)
   TypesMgr::TypeId t = getTypeDecor(ctx->ident());
-  if (not Types.isVoidFunction(t)) code = code || instruction::PUSH();
+  if (not Types.isVoidFunction(t)) code = std::move(code) || instruction::PUSH();
   
   // PUSH ALL PARAMETERS
   unsigned int i = 0; // PARAMETER INDEX
   for ( auto expr : ctx->expr()) {
     // PARAMETER i
     CodeAttribs && codAts2 = visit(expr);
-    code = code || codAts2.code;
+    code = std::move(code) || codAts2.code;
     std::string addr = codAts2.addr;
     
     TypesMgr::TypeId p = Types.getParameterType(t, i);
@@ -335,30 +336,30 @@ antlrcpp::Any CodeGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
     // INT TO FLOAT CASE
     if(Types.isFloatTy(p) and not Types.isFloatTy(e)){
       std::string temp = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp,addr);
+      code = std::move(code) || instruction::FLOAT(temp,addr);
       addr = temp;
     } // ARRAY AS PARAMETER(THE ADRESS IS NEEDED)
     else if (Types.isArrayTy(p) and not Symbols.isParameterClass(ctx->expr(i)->getText())) {
       std::string temp = "%"+codeCounters.newTEMP();
-      code = code || instruction::ALOAD(temp,addr);
+      code = std::move(code) || instruction::ALOAD(temp,addr);
       addr = temp;
     }
 
-    code = code || instruction::PUSH(addr);
+    code = std::move(code) || instruction::PUSH(addr);
     ++i;
   }
   
   // CALL FUNCTION
   std::string name = ctx->ident()->getText();
-  code = code || instruction::CALL(name); 
+  code = std::move(code) || instruction::CALL(name); 
 
   // POP ALL PARAMETERS
   for( long unsigned int i = 0; i<ctx->expr().size(); ++i){
-    code = code || instruction::POP();
+    code = std::move(code) || instruction::POP();
   }
   
   // POP RETURN VALUE SPACE
-  if (not Types.isVoidFunction(t)) code = code || instruction::POP();
+  if (not Types.isVoidFunction(t)) code = std::move(code) || instruction::POP();
   
   DEBUG_EXIT();
   return code;
@@ -371,9 +372,9 @@ antlrcpp::Any CodeGenVisitor::visitReturnExpr(AslParser::ReturnExprContext *ctx)
     CodeAttribs     && codAt1 = visit(ctx->expr());
     std::string         addr1 = codAt1.addr;
     instructionList &   code1 = codAt1.code;
-    code = code1 || instruction::LOAD("_result", addr1);
+    code = std::move(code1) || instruction::LOAD("_result", addr1);
   }
-  code = code || instruction::RETURN();
+  code = std::move(code) || instruction::RETURN();
   DEBUG_EXIT();
   return code;
 }
@@ -388,16 +389,16 @@ antlrcpp::Any CodeGenVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
   TypesMgr::TypeId tid = getTypeDecor(ctx->left_expr());
   
   std::string temp = "%"+codeCounters.newTEMP();
-  if (Types.isIntegerTy(tid) or Types.isBooleanTy(tid)) code1 = code1 || instruction::READI(temp);
-  else if (Types.isFloatTy(tid)) code1 = code1 || instruction::READF(temp);
-  else if (Types.isCharacterTy(tid)) code1 = code1 || instruction::READC(temp);
+  if (Types.isIntegerTy(tid) or Types.isBooleanTy(tid)) code1 = std::move(code1) || instruction::READI(temp);
+  else if (Types.isFloatTy(tid)) code1 = std::move(code1) || instruction::READF(temp);
+  else if (Types.isCharacterTy(tid)) code1 = std::move(code1) || instruction::READC(temp);
   else {
 	  std::cerr << "Type error in visitReadStmt" << std::endl;
 	  exit(0);
   }
   
-  if (offs1 != "") code1 = code1 || instruction::XLOAD(addr1, offs1, temp);
-  else code1 = code1 || instruction::LOAD(addr1, temp);
+  if (offs1 != "") code1 = std::move(code1) || instruction::XLOAD(addr1, offs1, temp);
+  else code1 = std::move(code1) || instruction::LOAD(addr1, temp);
   
   DEBUG_EXIT();
   return code1;
@@ -412,13 +413,13 @@ antlrcpp::Any CodeGenVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
   
   TypesMgr::TypeId tid1 = getTypeDecor(ctx->expr());
   if (Types.isFloatTy(tid1)) {
-      code = code1 || instruction::WRITEF(addr1);
+      code = std::move(code1) || instruction::WRITEF(addr1);
   }
   else if (Types.isCharacterTy(tid1)) {
-      code = code1 || instruction::WRITEC(addr1);
+      code = std::move(code1) || instruction::WRITEC(addr1);
   }
   else {
-      code = code1 || instruction::WRITEI(addr1);
+      code = std::move(code1) || instruction::WRITEI(addr1);
   }
   
   DEBUG_EXIT();
@@ -429,7 +430,7 @@ antlrcpp::Any CodeGenVisitor::visitWriteString(AslParser::WriteStringContext *ct
   DEBUG_ENTER();
   instructionList code;
   std::string s = ctx->STRING()->getText();
-  code = code || instruction::WRITES(s);
+  code = std::move(code) || instruction::WRITES(s);
   DEBUG_EXIT();
   return code;
 }
@@ -442,7 +443,7 @@ antlrcpp::Any CodeGenVisitor::visitLeft_expr(AslParser::Left_exprContext *ctx) {
   // ARRAYS
   if (ctx->expr()) {
     CodeAttribs && codAts2 = visit(ctx->expr());
-    code = code || codAts2.code;
+    code = std::move(code) || codAts2.code;
     codAts.offs = codAts2.addr;
   }
   
@@ -457,13 +458,13 @@ antlrcpp::Any CodeGenVisitor::visitFuncCall(AslParser::FuncCallContext *ctx) {
   TypesMgr::TypeId t = getTypeDecor(ctx->ident());
 
   // PUSH SPACE FOR RETURN VALUE
-  code = code || instruction::PUSH();
+  code = std::move(code) || instruction::PUSH();
 
   // PUSH ALL PARAMETERS
   unsigned int i = 0; // PARAMETER INDEX
   for (auto expr : ctx->expr()) {
     CodeAttribs && codAts2 = visit(expr);
-    code = code || codAts2.code;
+    code = std::move(code) || codAts2.code;
     std::string addr = codAts2.addr;
 
     TypesMgr::TypeId p = Types.getParameterType(t, i);
@@ -471,30 +472,30 @@ antlrcpp::Any CodeGenVisitor::visitFuncCall(AslParser::FuncCallContext *ctx) {
     // INT TO FLOAT CASE
     if (Types.isFloatTy(p) and not Types.isFloatTy(e)) {
       std::string temp = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(temp,addr);
+      code = std::move(code) || instruction::FLOAT(temp,addr);
       addr = temp;
     } //ARRAY AS PARAMETER(THE ADRESS IS NEEDED)
     else if (Types.isArrayTy(p) and not Symbols.isParameterClass(ctx->expr(i)->getText())){
       std::string temp = "%"+codeCounters.newTEMP();
-      code = code || instruction::ALOAD(temp,addr);
+      code = std::move(code) || instruction::ALOAD(temp,addr);
       addr = temp;
     }
-    code = code || instruction::PUSH(addr);
+    code = std::move(code) || instruction::PUSH(addr);
     ++i;
   }
 
   // CALL FUNCTION
   std::string name = ctx->ident()->getText();
-  code = code || instruction::CALL(name); 
+  code = std::move(code) || instruction::CALL(name); 
 
   // POP ALL PARAMETERS
   for (long unsigned int i = 0; i<ctx->expr().size(); ++i) {
-    code = code || instruction::POP();
+    code = std::move(code) || instruction::POP();
   }
 
   // GET RETURN VALUE SPACE
   std::string temp = "%"+codeCounters.newTEMP();
-  code = code || instruction::POP(temp);
+  code = std::move(code) || instruction::POP(temp);
   codAts.addr = temp;
 
   DEBUG_EXIT();
@@ -520,12 +521,12 @@ antlrcpp::Any CodeGenVisitor::visitUnary(AslParser::UnaryContext *ctx) {
   if (ctx->MINUS()){  
 		TypesMgr::TypeId t = getTypeDecor(ctx->expr());
 		if (Types.isFloatTy(t))
-		  code = code || instruction::FNEG(temp, addr);
+		  code = std::move(code) || instruction::FNEG(temp, addr);
 		else 
-		  code = code || instruction::NEG(temp, addr);
+		  code = std::move(code) || instruction::NEG(temp, addr);
   }
   else if (ctx->NOT()) {
-	  code = code || instruction::NOT(temp, addr);
+	  code = std::move(code) || instruction::NOT(temp, addr);
   }
 
   CodeAttribs codAts(temp, "", code);
@@ -544,7 +545,7 @@ antlrcpp::Any CodeGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx)
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
   std::string         addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
+  instructionList &&   code = std::move(code1) || std::move(code2);
   TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
 
   std::string temp = "%"+codeCounters.newTEMP();
@@ -553,53 +554,53 @@ antlrcpp::Any CodeGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx)
     // Convertir en int
     if (not Types.isFloatTy(t1)) {
       std::string tempFloat = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempFloat, addr1);
+      code = std::move(code) || instruction::FLOAT(tempFloat, addr1);
       addr1 = tempFloat;
     }
     else if (not Types.isFloatTy(t2)) {
       std::string tempFloat = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempFloat, addr2);
+      code = std::move(code) || instruction::FLOAT(tempFloat, addr2);
       addr2 = tempFloat;
     }
 
     // Hacer las instrucciones de coma flotante
     if (ctx->MUL()) {
-        code = code || instruction::FMUL(temp, addr1, addr2);
+        code = std::move(code) || instruction::FMUL(temp, addr1, addr2);
     }
     else if (ctx->DIV()) {
-        code = code || instruction::FDIV(temp, addr1, addr2);
+        code = std::move(code) || instruction::FDIV(temp, addr1, addr2);
     }
     else if (ctx->MOD()) {
         std::cerr << "FUMAS PETARDOS BRO" << std::endl;
         exit(0);
     }
     else if (ctx->PLUS()) {
-        code = code || instruction::FADD(temp, addr1, addr2);
+        code = std::move(code) || instruction::FADD(temp, addr1, addr2);
     }
     else if (ctx->MINUS()) {
-        code = code || instruction::FSUB(temp, addr1, addr2);
+        code = std::move(code) || instruction::FSUB(temp, addr1, addr2);
     }
   }
   else {
     if (ctx->MUL()) {
-      code = code || instruction::MUL(temp, addr1, addr2);
+      code = std::move(code) || instruction::MUL(temp, addr1, addr2);
     }
     else if (ctx->DIV()) {
-      code = code || instruction::DIV(temp, addr1, addr2);
+      code = std::move(code) || instruction::DIV(temp, addr1, addr2);
     }
     else if (ctx->MOD()) {
       std::string tempDIV = "%"+codeCounters.newTEMP();
       std::string tempMULT = "%"+codeCounters.newTEMP();
-      code = code
+      code = std::move(code)
 		    || instruction::DIV(tempDIV, addr1, addr2)
 		    || instruction::MUL(tempMULT, tempDIV, addr2)
 		    || instruction::SUB(temp, addr1, tempMULT);
     }
     else if (ctx->PLUS()) {
-      code = code || instruction::ADD(temp, addr1, addr2);
+      code = std::move(code) || instruction::ADD(temp, addr1, addr2);
     }
     else if (ctx->MINUS()) {
-      code = code || instruction::SUB(temp, addr1, addr2);
+      code = std::move(code) || instruction::SUB(temp, addr1, addr2);
     }
   }
 
@@ -619,56 +620,56 @@ antlrcpp::Any CodeGenVisitor::visitRelational(AslParser::RelationalContext *ctx)
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
   std::string         addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
+  instructionList &&   code = std::move(code1) || std::move(code2);
   TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
   
   std::string temp = "%"+codeCounters.newTEMP();
 
-  // code = code || instruction::EQ(temp, addr1, addr2);
+  // code = std::move(code) || instruction::EQ(temp, addr1, addr2);
 
   if (Types.isFloatTy(t1) or Types.isFloatTy(t2)) {
     // FLOAT AND INT(int need to be converted to float)
     if (not Types.isFloatTy(t1)) {
       std::string tempf1 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempf1,addr1);
+      code = std::move(code) || instruction::FLOAT(tempf1,addr1);
       addr1 = tempf1;
     }
     else if (not Types.isFloatTy(t2)) {
       std::string tempf2 = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempf2,addr2);
+      code = std::move(code) || instruction::FLOAT(tempf2,addr2);
       addr2 = tempf2;
     }
 
     if (ctx->EQUAL())
-      code = code || instruction::FEQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::FEQ(temp, addr1, addr2);
     else if (ctx->DIFF()){
-      code = code || instruction::FEQ(temp, addr1, addr2);
-      code = code || instruction::NOT(temp, temp);
+      code = std::move(code) || instruction::FEQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::NOT(temp, temp);
     }
     else if (ctx->LS())
-      code = code || instruction::FLT(temp, addr1, addr2);
+      code = std::move(code) || instruction::FLT(temp, addr1, addr2);
     else if (ctx->BS())
-      code = code || instruction::FLT(temp, addr2, addr1);
+      code = std::move(code) || instruction::FLT(temp, addr2, addr1);
     else if (ctx->LE())
-      code = code || instruction::FLE(temp, addr1, addr2);
+      code = std::move(code) || instruction::FLE(temp, addr1, addr2);
     else if (ctx->BE())
-      code = code || instruction::FLE(temp, addr2, addr1);
+      code = std::move(code) || instruction::FLE(temp, addr2, addr1);
   }
   else {// INTs CASE
     if (ctx->EQUAL())
-      code = code || instruction::EQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::EQ(temp, addr1, addr2);
     else if (ctx->DIFF()){
-      code = code || instruction::EQ(temp, addr1, addr2);
-      code = code || instruction::NOT(temp, temp);
+      code = std::move(code) || instruction::EQ(temp, addr1, addr2);
+      code = std::move(code) || instruction::NOT(temp, temp);
     }
     else if (ctx->LS())
-      code = code || instruction::LT(temp, addr1, addr2);
+      code = std::move(code) || instruction::LT(temp, addr1, addr2);
     else if (ctx->BS())
-      code = code || instruction::LT(temp, addr2, addr1);
+      code = std::move(code) || instruction::LT(temp, addr2, addr1);
     else if (ctx->LE())
-      code = code || instruction::LE(temp, addr1, addr2);
+      code = std::move(code) || instruction::LE(temp, addr1, addr2);
     else if (ctx->BE())
-      code = code || instruction::LE(temp, addr2, addr1);
+      code = std::move(code) || instruction::LE(temp, addr2, addr1);
   }
   CodeAttribs codAts(temp, "", code);
   DEBUG_EXIT();
@@ -685,14 +686,14 @@ antlrcpp::Any CodeGenVisitor::visitBoolean(AslParser::BooleanContext *ctx) {
   CodeAttribs     && codAt2 = visit(ctx->expr(1));
   std::string         addr2 = codAt2.addr;
   instructionList &   code2 = codAt2.code;
-  instructionList &&   code = code1 || code2;
+  instructionList &&   code = std::move(code1) || std::move(code2);
 
   std::string temp = "%"+codeCounters.newTEMP();
   
   if (ctx->AND())
-    code = code || instruction::AND(temp, addr1, addr2);
+    code = std::move(code) || instruction::AND(temp, addr1, addr2);
   else if (ctx->OR())
-    code = code || instruction::OR(temp, addr1, addr2);
+    code = std::move(code) || instruction::OR(temp, addr1, addr2);
   
   CodeAttribs codAts(temp, "", code);
   DEBUG_EXIT();
@@ -742,10 +743,10 @@ antlrcpp::Any CodeGenVisitor::visitArrayIndex(AslParser::ArrayIndexContext *ctx)
   instructionList & code = codAts.code;
   
     CodeAttribs && codAts2 = visit(ctx->expr());
-    code = code || codAts2.code;
+    code = std::move(code) || codAts2.code;
 
     std::string temp = "%"+codeCounters.newTEMP();
-    code = code || instruction::LOADX(temp, codAts.addr, codAts2.addr);
+    code = std::move(code) || instruction::LOADX(temp, codAts.addr, codAts2.addr);
     codAts.addr = temp;
 
   DEBUG_EXIT();
@@ -760,7 +761,7 @@ antlrcpp::Any CodeGenVisitor::visitIdent(AslParser::IdentContext *ctx) {
   TypesMgr::TypeId t = getTypeDecor(ctx);
   if (Types.isArrayTy(t) and Symbols.isParameterClass(ctx->ID()->getText())) {
 	  std::string temp = "%"+codeCounters.newTEMP();
-	  code = code || instruction::LOAD(temp, codAts.addr);
+	  code = std::move(code) || instruction::LOAD(temp, codAts.addr);
 	  codAts.addr = temp;
   }
   
@@ -790,5 +791,5 @@ CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
 CodeGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
                                          const std::string & offs,
                                          instructionList && code) :
-  addr{addr}, offs{offs}, code{code} {
+  addr{addr}, offs{offs}, code{std::move(code)} {
 }
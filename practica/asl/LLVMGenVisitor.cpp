@@ -0,0 +1,881 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    LLVMGenVisitor - Walk the parser tree to emit LLVM IR
+//                     directly, without t-code in between
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "LLVMGenVisitor.h"
+#include "antlr4-runtime.h"
+
+#include "../common/TypesMgr.h"
+#include "../common/SymTable.h"
+#include "../common/TreeDecoration.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>    // std::uint64_t
+#include <cstdio>     // std::snprintf
+#include <cstdlib>    // std::strtof
+#include <cstring>    // std::memcpy
+
+// uncomment the following line to enable debugging messages with DEBUG*
+// #define DEBUG_BUILD
+#include "../common/debug.h"
+
+// using namespace std;
+
+// same layout as the t-code translator (LLVMCodeGen)
+static const std::string INDENT_INSTR = "    ";
+static const std::string INDENT_LABEL = "  ";
+
+
+// Constructor
+LLVMGenVisitor::LLVMGenVisitor(TypesMgr       & Types,
+                               SymTable       & Symbols,
+                               TreeDecoration & Decorations,
+                               bool             bufferedIO) :
+  Types{Types},
+  Symbols{Symbols},
+  Decorations{Decorations},
+  bufferedIO{bufferedIO},
+  tempCount{0},
+  labelCount{0},
+  usesPrintf{false},
+  usesPutchar{false},
+  usesScanf{false},
+  usesMemcpy{false},
+  usesReadBool{false},
+  rtWriteI{false},
+  rtWriteF{false},
+  rtWriteC{false},
+  rtWriteS{false},
+  rtReadI{false},
+  rtReadF{false},
+  rtReadC{false},
+  needFmtI{false},
+  needFmtF{false},
+  needFmtC{false} {
+}
+
+// Accessor/Mutator to the attribute currFunctionType
+TypesMgr::TypeId LLVMGenVisitor::getCurrentFunctionTy() const {
+  return currFunctionType;
+}
+
+void LLVMGenVisitor::setCurrentFunctionTy(TypesMgr::TypeId type) {
+  currFunctionType = type;
+}
+
+// fresh single-assignment register / fresh label
+std::string LLVMGenVisitor::newTemp() {
+  return "%t" + std::to_string(++tempCount);
+}
+
+std::string LLVMGenVisitor::newLabel(const std::string & base) {
+  return base + "." + std::to_string(++labelCount);
+}
+
+// the LLVM type of an Asl basic type
+std::string LLVMGenVisitor::llvmType(TypesMgr::TypeId tid) const {
+  if (Types.isIntegerTy(tid))        return "i32";
+  else if (Types.isFloatTy(tid))     return "float";
+  else if (Types.isCharacterTy(tid)) return "i8";
+  else if (Types.isBooleanTy(tid))   return "i1";
+  return "void";
+}
+
+// an LLVM constant of that type equal to zero
+std::string LLVMGenVisitor::llvmZero(TypesMgr::TypeId tid) const {
+  if (Types.isFloatTy(tid))        return "0.000000e+00";
+  else if (Types.isBooleanTy(tid)) return "false";
+  return "0";
+}
+
+// an Asl float literal as an LLVM constant. LLVM only accepts a
+// decimal literal for a 'float' operand when it is exactly
+// representable, so the value is printed as the bit pattern of the
+// float widened to double (the form clang itself emits)
+std::string LLVMGenVisitor::llvmFloat(const std::string & text) {
+  float  f = std::strtof(text.c_str(), nullptr);
+  double d = f;
+  std::uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "0x%016llX", (unsigned long long)bits);
+  return std::string(buf);
+}
+
+// the character code of an Asl char literal ('a', '\n', ...)
+int LLVMGenVisitor::charCode(const std::string & text) {
+  std::string body = text.substr(1, text.size()-2);
+  if (body.size() == 2 and body[0] == '\\') {
+    switch (body[1]) {
+      case 'n':  return '\n';
+      case 't':  return '\t';
+      case 'r':  return '\r';
+      case 'b':  return '\b';
+      case 'f':  return '\f';
+      case '\\': return '\\';
+      case '\'': return '\'';
+      case '"':  return '"';
+    }
+  }
+  return body[0];
+}
+
+// register the processed body of an Asl string literal as a global
+// @.str.s.N (same processing as LLVMCodeGen::getLLVMStringFromAslString)
+// and return the name of that global; 'size' gets its size in bytes
+std::string LLVMGenVisitor::addStringLit(const std::string & s, std::size_t & size) {
+  std::string body = s.substr(1, s.size()-2);
+  size = body.size();
+  for (const auto & from_to : std::vector<std::pair<std::string, std::string>>
+                              {{"\\n", "\\0A"}, {"\\t", "\\09"}, {"\\\\", "\\\\"}}) {
+    const std::string & from = from_to.first;
+    const std::string & to   = from_to.second;
+    std::string::size_type pos = 0;
+    while ((pos = body.find(from, pos)) != std::string::npos) {
+      body.replace(pos, from.length(), to);
+      size = size - from.size() + 1;
+      pos += to.length();
+    }
+  }
+  size += 1;  // the closing \00
+  std::string name = "@.str.s." + std::to_string(stringLits.size()+1);
+  stringLits.push_back(name + " = constant [" + std::to_string(size) +
+                       " x i8] c\"" + body + "\\00\"\n");
+  return name;
+}
+
+// address of the first element of an array (decayed local array, or
+// the pointer an array parameter holds in its alloca)
+std::string LLVMGenVisitor::arrayBaseAddr(const std::string & name,
+                                          TypesMgr::TypeId    arrayTy,
+                                          std::string       & code) {
+  std::string elemT = llvmType(Types.getArrayElemType(arrayTy));
+  std::string temp  = newTemp();
+  if (Symbols.isParameterClass(name)) {
+    code += INDENT_INSTR + temp + " = load " + elemT + "*, " + elemT +
+            "** %" + name + ".addr\n";
+  }
+  else {
+    std::string arrT = "[" + std::to_string(Types.getArraySize(arrayTy)) +
+                       " x " + elemT + "]";
+    code += INDENT_INSTR + temp + " = getelementptr inbounds " + arrT + ", " +
+            arrT + "* %" + name + ".addr, i64 0, i64 0\n";
+  }
+  return temp;
+}
+
+// address of element 'index' of an array
+std::string LLVMGenVisitor::arrayElemAddr(const std::string & name,
+                                          TypesMgr::TypeId    arrayTy,
+                                          const std::string & index,
+                                          std::string       & code) {
+  std::string elemT = llvmType(Types.getArrayElemType(arrayTy));
+  std::string idx64 = newTemp();
+  code += INDENT_INSTR + idx64 + " = sext i32 " + index + " to i64\n";
+  std::string temp = newTemp();
+  if (Symbols.isParameterClass(name)) {
+    std::string base = newTemp();
+    code += INDENT_INSTR + base + " = load " + elemT + "*, " + elemT +
+            "** %" + name + ".addr\n";
+    code += INDENT_INSTR + temp + " = getelementptr inbounds " + elemT + ", " +
+            elemT + "* " + base + ", i64 " + idx64 + "\n";
+  }
+  else {
+    std::string arrT = "[" + std::to_string(Types.getArraySize(arrayTy)) +
+                       " x " + elemT + "]";
+    code += INDENT_INSTR + temp + " = getelementptr inbounds " + arrT + ", " +
+            arrT + "* %" + name + ".addr, i64 0, i64 " + idx64 + "\n";
+  }
+  return temp;
+}
+
+// sitofp conversion when a float is expected and an integer arrives
+std::string LLVMGenVisitor::makeFloat(const std::string & addr,
+                                      TypesMgr::TypeId    exprTy,
+                                      TypesMgr::TypeId    expectedTy,
+                                      std::string       & code) {
+  if (not Types.isFloatTy(expectedTy) or Types.isFloatTy(exprTy)) return addr;
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = sitofp i32 " + addr + " to float\n";
+  return temp;
+}
+
+
+// Methods to visit each kind of node:
+//
+antlrcpp::Any LLVMGenVisitor::visitProgram(AslParser::ProgramContext *ctx) {
+  DEBUG_ENTER();
+  std::string funcs;
+  SymTable::ScopeId sc = getScopeDecor(ctx);
+  Symbols.pushThisScope(sc);
+  for (auto ctxFunc : ctx->function()) {
+    std::string oneFunc = visit(ctxFunc);
+    funcs += oneFunc + "\n";
+  }
+  Symbols.popScope();
+  // assemble the module: globals, functions, runtime declarations
+  std::string begin;
+  if (needFmtI) begin += "@.str.i = constant [3 x i8] c\"%d\\00\"\n";
+  if (needFmtF) begin += "@.str.f = constant [3 x i8] c\"%g\\00\"\n";
+  if (needFmtC) begin += "@.str.c = constant [3 x i8] c\"%c\\00\"\n";
+  for (auto & lit : stringLits) begin += lit;
+  if (usesReadBool) begin += "@.global.i.addr = common dso_local global i32 0\n";
+  if (not begin.empty()) begin += "\n";
+  std::string end;
+  if (usesPrintf)  end += "declare dso_local i32 @printf(i8*, ...)\n";
+  if (usesPutchar) end += "declare dso_local i32 @putchar(i32)\n";
+  if (usesScanf)   end += "declare dso_local i32 @__isoc99_scanf(i8*, ...)\n";
+  if (usesMemcpy)  end += "declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)\n";
+  if (rtWriteI)    end += "declare void @asl_writei(i32)\n";
+  if (rtWriteF)    end += "declare void @asl_writef(float)\n";
+  if (rtWriteC)    end += "declare void @asl_writec(i32)\n";
+  if (rtWriteS)    end += "declare void @asl_writes(i8*)\n";
+  if (rtReadI)     end += "declare i32 @asl_readi()\n";
+  if (rtReadF)     end += "declare float @asl_readf()\n";
+  if (rtReadC)     end += "declare i32 @asl_readc()\n";
+  DEBUG_EXIT();
+  return begin + funcs + end;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitFunction(AslParser::FunctionContext *ctx) {
+  DEBUG_ENTER();
+  SymTable::ScopeId sc = getScopeDecor(ctx);
+  Symbols.pushThisScope(sc);
+  tempCount  = 0;
+  labelCount = 0;
+  std::string funcName = ctx->ID()->getText();
+  bool isMain = (funcName == "main");
+
+  // RETURN TYPE
+  if (ctx->basic_type()) setCurrentFunctionTy(getTypeDecor(ctx->basic_type()));
+  std::string retType;
+  if (ctx->basic_type()) retType = llvmType(getCurrentFunctionTy());
+  else                   retType = isMain ? "i32" : "void";
+
+  // HEADER
+  std::string head = "define dso_local ";
+  if (isMain) head += "i32 @main()";
+  else {
+    head += retType + " @" + funcName + "(";
+    bool firstParam = true;
+    for (auto i : ctx->parameter_decl()) {
+      TypesMgr::TypeId tp = getTypeDecor(i->type());
+      std::string paramT;
+      if (Types.isArrayTy(tp)) paramT = llvmType(Types.getArrayElemType(tp)) + "*";
+      else                     paramT = llvmType(tp);
+      if (not firstParam) head += ", ";
+      firstParam = false;
+      head += paramT + " %" + i->ID()->getText();
+    }
+    head += ")";
+  }
+  std::string code = head + " {\n" + INDENT_LABEL + ".entry:\n";
+
+  // ALLOCAS: parameters, then local variables
+  for (auto i : ctx->parameter_decl()) {
+    TypesMgr::TypeId tp = getTypeDecor(i->type());
+    std::string paramT;
+    if (Types.isArrayTy(tp)) paramT = llvmType(Types.getArrayElemType(tp)) + "*";
+    else                     paramT = llvmType(tp);
+    code += INDENT_INSTR + "%" + i->ID()->getText() + ".addr = alloca " + paramT + "\n";
+  }
+  for (auto v : ctx->declarations()->variable_decl()) {
+    TypesMgr::TypeId tv = getTypeDecor(v->type());
+    std::string varT;
+    if (Types.isArrayTy(tv))
+      varT = "[" + std::to_string(Types.getArraySize(tv)) + " x " +
+             llvmType(Types.getArrayElemType(tv)) + "]";
+    else
+      varT = llvmType(tv);
+    for (auto id : v->ID())
+      code += INDENT_INSTR + "%" + id->getText() + ".addr = alloca " + varT + "\n";
+  }
+
+  // PARAMETER INITIALIZATION
+  for (auto i : ctx->parameter_decl()) {
+    TypesMgr::TypeId tp = getTypeDecor(i->type());
+    std::string paramT;
+    if (Types.isArrayTy(tp)) paramT = llvmType(Types.getArrayElemType(tp)) + "*";
+    else                     paramT = llvmType(tp);
+    std::string name = i->ID()->getText();
+    code += INDENT_INSTR + "store " + paramT + " %" + name + ", " + paramT +
+            "* %" + name + ".addr\n";
+  }
+
+  // STATEMENTS
+  std::string body = visit(ctx->statements());
+  code += body;
+
+  // DEFAULT RETURN (a 'return' inside the body opened a fresh block,
+  // so the current block never has a terminator yet)
+  if (isMain)                 code += INDENT_INSTR + "ret i32 0\n";
+  else if (ctx->basic_type()) code += INDENT_INSTR + "ret " + retType + " " +
+                                      llvmZero(getCurrentFunctionTy()) + "\n";
+  else                        code += INDENT_INSTR + "ret void\n";
+  code += "}\n";
+
+  Symbols.popScope();
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitStatements(AslParser::StatementsContext *ctx) {
+  DEBUG_ENTER();
+  std::string code;
+  for (auto stCtx : ctx->statement()) {
+    std::string oneStmt = visit(stCtx);
+    code += oneStmt;
+  }
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitAssignStmt(AslParser::AssignStmtContext *ctx) {
+  DEBUG_ENTER();
+  TypesMgr::TypeId tid1 = getTypeDecor(ctx->left_expr());
+  TypesMgr::TypeId tid2 = getTypeDecor(ctx->expr());
+
+  // WHOLE ARRAY ASSIGNMENT (copy the storage with memcpy)
+  if (Types.isArrayTy(tid1) and Types.isArrayTy(tid2)) {
+    std::string code;
+    std::string elemT = llvmType(Types.getArrayElemType(tid1));
+    std::string dst = arrayBaseAddr(ctx->left_expr()->ident()->ID()->getText(), tid1, code);
+    std::string src = arrayBaseAddr(ctx->expr()->getText(), tid2, code);
+    std::string dst8 = newTemp();
+    std::string src8 = newTemp();
+    code += INDENT_INSTR + dst8 + " = bitcast " + elemT + "* " + dst + " to i8*\n";
+    code += INDENT_INSTR + src8 + " = bitcast " + elemT + "* " + src + " to i8*\n";
+    std::size_t elemSize = (elemT == "i32" or elemT == "float") ? 4 : 1;
+    std::size_t numBytes = Types.getArraySize(tid1) * elemSize;
+    code += INDENT_INSTR + "call void @llvm.memcpy.p0i8.p0i8.i64(i8* " + dst8 +
+            ", i8* " + src8 + ", i64 " + std::to_string(numBytes) + ", i1 false)\n";
+    usesMemcpy = true;
+    DEBUG_EXIT();
+    return code;
+  }
+
+  CodeAttribs && codAtsL = visit(ctx->left_expr());
+  CodeAttribs && codAtsE = visit(ctx->expr());
+  std::string code = codAtsL.code + codAtsE.code;
+  std::string addr = makeFloat(codAtsE.addr, tid2, tid1, code);
+  code += INDENT_INSTR + "store " + llvmType(tid1) + " " + addr + ", " +
+          llvmType(tid1) + "* " + codAtsL.addr + "\n";
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitIfStmt(AslParser::IfStmtContext *ctx) {
+  DEBUG_ENTER();
+  std::string labelNum  = std::to_string(++labelCount);
+  std::string labelThen = "if.then." + labelNum;
+  std::string labelElse = "if.else." + labelNum;
+  std::string labelEnd  = "if.end."  + labelNum;
+  bool hasElse = (ctx->statements().size() > 1);
+
+  CodeAttribs && codAtsE = visit(ctx->expr());
+  std::string code = codAtsE.code;
+  code += INDENT_INSTR + "br i1 " + codAtsE.addr + ", label %" + labelThen +
+          ", label %" + (hasElse ? labelElse : labelEnd) + "\n";
+  code += INDENT_LABEL + labelThen + ":\n";
+  std::string thenCode = visit(ctx->statements(0));
+  code += thenCode;
+  code += INDENT_INSTR + "br label %" + labelEnd + "\n";
+  if (hasElse) {
+    code += INDENT_LABEL + labelElse + ":\n";
+    std::string elseCode = visit(ctx->statements(1));
+    code += elseCode;
+    code += INDENT_INSTR + "br label %" + labelEnd + "\n";
+  }
+  code += INDENT_LABEL + labelEnd + ":\n";
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitWhileStmt(AslParser::WhileStmtContext *ctx) {
+  DEBUG_ENTER();
+  std::string labelNum  = std::to_string(++labelCount);
+  std::string labelCond = "while.cond." + labelNum;
+  std::string labelBody = "while.body." + labelNum;
+  std::string labelEnd  = "while.end."  + labelNum;
+
+  std::string code;
+  code += INDENT_INSTR + "br label %" + labelCond + "\n";
+  code += INDENT_LABEL + labelCond + ":\n";
+  CodeAttribs && codAtsE = visit(ctx->expr());
+  code += codAtsE.code;
+  code += INDENT_INSTR + "br i1 " + codAtsE.addr + ", label %" + labelBody +
+          ", label %" + labelEnd + "\n";
+  code += INDENT_LABEL + labelBody + ":\n";
+  std::string bodyCode = visit(ctx->statements());
+  code += bodyCode;
+  code += INDENT_INSTR + "br label %" + labelCond + "\n";
+  code += INDENT_LABEL + labelEnd + ":\n";
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitProcCall(AslParser::ProcCallContext *ctx) {
+  DEBUG_ENTER();
+  std::string code;
+  TypesMgr::TypeId t = getTypeDecor(ctx->ident());
+  std::string funcName = ctx->ident()->ID()->getText();
+
+  // ARGUMENTS (with the same coercions as a call in an expression)
+  std::string args;
+  unsigned int i = 0;
+  for (auto expr : ctx->expr()) {
+    CodeAttribs && codAts2 = visit(expr);
+    code += codAts2.code;
+    std::string addr = codAts2.addr;
+    TypesMgr::TypeId p = Types.getParameterType(t, i);
+    TypesMgr::TypeId e = getTypeDecor(expr);
+    std::string argT;
+    if (Types.isArrayTy(p)) {
+      addr = arrayBaseAddr(ctx->expr(i)->getText(), e, code);
+      argT = llvmType(Types.getArrayElemType(p)) + "*";
+    }
+    else {
+      addr = makeFloat(addr, e, p, code);
+      argT = llvmType(p);
+    }
+    if (i > 0) args += ", ";
+    args += argT + " " + addr;
+    ++i;
+  }
+
+  std::string retType = Types.isVoidFunction(t) ? "void"
+                        : llvmType(Types.getFuncReturnType(t));
+  code += INDENT_INSTR + "call " + retType + " @" + funcName + "(" + args + ")\n";
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitReturnExpr(AslParser::ReturnExprContext *ctx) {
+  DEBUG_ENTER();
+  std::string code;
+  if (ctx->expr()) {
+    CodeAttribs && codAt1 = visit(ctx->expr());
+    code += codAt1.code;
+    TypesMgr::TypeId e = getTypeDecor(ctx->expr());
+    std::string addr = makeFloat(codAt1.addr, e, getCurrentFunctionTy(), code);
+    code += INDENT_INSTR + "ret " + llvmType(getCurrentFunctionTy()) + " " + addr + "\n";
+  }
+  else {
+    code += INDENT_INSTR + "ret void\n";
+  }
+  // a block cannot continue after 'ret': open a fresh (unreachable)
+  // one for whatever follows, like the t-code translator does
+  code += INDENT_LABEL + newLabel("ret.cont") + ":\n";
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitReadStmt(AslParser::ReadStmtContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAts = visit(ctx->left_expr());
+  std::string code = codAts.code;
+  TypesMgr::TypeId tid = getTypeDecor(ctx->left_expr());
+  if (bufferedIO) {
+    // the runtime returns the value, so every target type stores the
+    // call result and booleans need no global cell
+    if (Types.isBooleanTy(tid)) {
+      rtReadI = true;
+      std::string tempI = newTemp();
+      std::string tempB = newTemp();
+      code += INDENT_INSTR + tempI + " = call i32 @asl_readi()\n";
+      code += INDENT_INSTR + tempB + " = icmp ne i32 " + tempI + ", 0\n";
+      code += INDENT_INSTR + "store i1 " + tempB + ", i1* " + codAts.addr + "\n";
+    }
+    else if (Types.isCharacterTy(tid)) {
+      rtReadC = true;
+      std::string tempI = newTemp();
+      std::string tempC = newTemp();
+      code += INDENT_INSTR + tempI + " = call i32 @asl_readc()\n";
+      code += INDENT_INSTR + tempC + " = trunc i32 " + tempI + " to i8\n";
+      code += INDENT_INSTR + "store i8 " + tempC + ", i8* " + codAts.addr + "\n";
+    }
+    else {
+      std::string temp = newTemp();
+      if (Types.isFloatTy(tid)) {
+        rtReadF = true;
+        code += INDENT_INSTR + temp + " = call float @asl_readf()\n";
+      }
+      else {
+        rtReadI = true;
+        code += INDENT_INSTR + temp + " = call i32 @asl_readi()\n";
+      }
+      code += INDENT_INSTR + "store " + llvmType(tid) + " " + temp + ", " +
+              llvmType(tid) + "* " + codAts.addr + "\n";
+    }
+    DEBUG_EXIT();
+    return code;
+  }
+  usesScanf = true;
+  if (Types.isBooleanTy(tid)) {
+    // scanf has no i1 conversion: read an int into a global cell and
+    // store the 'is not zero' of it (same scheme as the translator)
+    needFmtI = true;
+    usesReadBool = true;
+    code += INDENT_INSTR + "call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.str.i, i64 0, i64 0), i32* @.global.i.addr)\n";
+    std::string tempI = newTemp();
+    std::string tempB = newTemp();
+    code += INDENT_INSTR + tempI + " = load i32, i32* @.global.i.addr\n";
+    code += INDENT_INSTR + tempB + " = icmp ne i32 " + tempI + ", 0\n";
+    code += INDENT_INSTR + "store i1 " + tempB + ", i1* " + codAts.addr + "\n";
+  }
+  else {
+    std::string format;
+    if (Types.isIntegerTy(tid))        { format = "@.str.i"; needFmtI = true; }
+    else if (Types.isFloatTy(tid))     { format = "@.str.f"; needFmtF = true; }
+    else                               { format = "@.str.c"; needFmtC = true; }
+    code += INDENT_INSTR + "call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* " +
+            format + ", i64 0, i64 0), " + llvmType(tid) + "* " + codAts.addr + ")\n";
+  }
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitWriteExpr(AslParser::WriteExprContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAt1 = visit(ctx->expr());
+  std::string code = codAt1.code;
+  TypesMgr::TypeId tid1 = getTypeDecor(ctx->expr());
+  if (Types.isFloatTy(tid1)) {
+    if (bufferedIO) {
+      rtWriteF = true;
+      code += INDENT_INSTR + "call void @asl_writef(float " + codAt1.addr + ")\n";
+    }
+    else {
+      usesPrintf = true;
+      needFmtF = true;
+      std::string temp = newTemp();
+      code += INDENT_INSTR + temp + " = fpext float " + codAt1.addr + " to double\n";
+      code += INDENT_INSTR + "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.str.f, i64 0, i64 0), double " + temp + ")\n";
+    }
+  }
+  else if (Types.isCharacterTy(tid1)) {
+    std::string temp = newTemp();
+    code += INDENT_INSTR + temp + " = zext i8 " + codAt1.addr + " to i32\n";
+    if (bufferedIO) {
+      rtWriteC = true;
+      code += INDENT_INSTR + "call void @asl_writec(i32 " + temp + ")\n";
+    }
+    else {
+      usesPutchar = true;
+      code += INDENT_INSTR + "call i32 @putchar(i32 " + temp + ")\n";
+    }
+  }
+  else {
+    std::string addr = codAt1.addr;
+    if (Types.isBooleanTy(tid1)) {    // booleans are written as 0/1
+      std::string temp = newTemp();
+      code += INDENT_INSTR + temp + " = zext i1 " + addr + " to i32\n";
+      addr = temp;
+    }
+    if (bufferedIO) {
+      rtWriteI = true;
+      code += INDENT_INSTR + "call void @asl_writei(i32 " + addr + ")\n";
+    }
+    else {
+      usesPrintf = true;
+      needFmtI = true;
+      code += INDENT_INSTR + "call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([3 x i8], [3 x i8]* @.str.i, i64 0, i64 0), i32 " + addr + ")\n";
+    }
+  }
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitWriteString(AslParser::WriteStringContext *ctx) {
+  DEBUG_ENTER();
+  std::size_t size;
+  std::string name = addStringLit(ctx->STRING()->getText(), size);
+  std::string strT = "[" + std::to_string(size) + " x i8]";
+  std::string code;
+  if (bufferedIO) {
+    rtWriteS = true;
+    code = INDENT_INSTR + "call void @asl_writes(i8* getelementptr inbounds (" +
+           strT + ", " + strT + "* " + name + ", i64 0, i64 0))\n";
+  }
+  else {
+    usesPrintf = true;
+    code = INDENT_INSTR + "call i32 (i8*, ...) @printf(i8* getelementptr inbounds (" +
+           strT + ", " + strT + "* " + name + ", i64 0, i64 0))\n";
+  }
+  DEBUG_EXIT();
+  return code;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitLeft_expr(AslParser::Left_exprContext *ctx) {
+  DEBUG_ENTER();
+  std::string name = ctx->ident()->ID()->getText();
+  std::string code;
+  std::string addr;
+  if (ctx->expr()) {
+    TypesMgr::TypeId t = getTypeDecor(ctx->ident());
+    CodeAttribs && codAts2 = visit(ctx->expr());
+    code += codAts2.code;
+    addr = arrayElemAddr(name, t, codAts2.addr, code);
+  }
+  else {
+    addr = "%" + name + ".addr";
+  }
+  CodeAttribs codAts(addr, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitFuncCall(AslParser::FuncCallContext *ctx) {
+  DEBUG_ENTER();
+  std::string code;
+  TypesMgr::TypeId t = getTypeDecor(ctx->ident());
+  std::string funcName = ctx->ident()->ID()->getText();
+
+  // ARGUMENTS
+  std::string args;
+  unsigned int i = 0;
+  for (auto expr : ctx->expr()) {
+    CodeAttribs && codAts2 = visit(expr);
+    code += codAts2.code;
+    std::string addr = codAts2.addr;
+    TypesMgr::TypeId p = Types.getParameterType(t, i);
+    TypesMgr::TypeId e = getTypeDecor(expr);
+    std::string argT;
+    if (Types.isArrayTy(p)) {
+      addr = arrayBaseAddr(ctx->expr(i)->getText(), e, code);
+      argT = llvmType(Types.getArrayElemType(p)) + "*";
+    }
+    else {
+      addr = makeFloat(addr, e, p, code);
+      argT = llvmType(p);
+    }
+    if (i > 0) args += ", ";
+    args += argT + " " + addr;
+    ++i;
+  }
+
+  std::string retType = llvmType(Types.getFuncReturnType(t));
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = call " + retType + " @" + funcName +
+          "(" + args + ")\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitParenthesis(AslParser::ParenthesisContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAts = visit(ctx->expr());
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitUnary(AslParser::UnaryContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAts = visit(ctx->expr());
+  std::string code = codAts.code;
+  TypesMgr::TypeId t = getTypeDecor(ctx->expr());
+  std::string addr = codAts.addr;
+  if (ctx->NOT()) {
+    std::string temp = newTemp();
+    code += INDENT_INSTR + temp + " = xor i1 " + addr + ", 1\n";
+    addr = temp;
+  }
+  else if (ctx->MINUS()) {
+    std::string temp = newTemp();
+    if (Types.isFloatTy(t))
+      code += INDENT_INSTR + temp + " = fneg float " + addr + "\n";
+    else
+      code += INDENT_INSTR + temp + " = sub i32 0, " + addr + "\n";
+    addr = temp;
+  }
+  // unary PLUS: the value itself
+  CodeAttribs codAtsR(addr, "", code);
+  DEBUG_EXIT();
+  return codAtsR;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitArithmetic(AslParser::ArithmeticContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAt1 = visit(ctx->expr(0));
+  CodeAttribs && codAt2 = visit(ctx->expr(1));
+  std::string code = codAt1.code + codAt2.code;
+  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
+  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
+  TypesMgr::TypeId t  = getTypeDecor(ctx);
+
+  std::string addr1 = makeFloat(codAt1.addr, t1, t, code);
+  std::string addr2 = makeFloat(codAt2.addr, t2, t, code);
+
+  std::string oper;
+  if (Types.isFloatTy(t)) {
+    if      (ctx->MUL())   oper = "fmul";
+    else if (ctx->DIV())   oper = "fdiv";
+    else if (ctx->PLUS())  oper = "fadd";
+    else                   oper = "fsub";
+  }
+  else {
+    if      (ctx->MUL())   oper = "mul";
+    else if (ctx->DIV())   oper = "sdiv";
+    else if (ctx->MOD())   oper = "srem";
+    else if (ctx->PLUS())  oper = "add";
+    else                   oper = "sub";
+  }
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = " + oper + " " + llvmType(t) + " " +
+          addr1 + ", " + addr2 + "\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitRelational(AslParser::RelationalContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAt1 = visit(ctx->expr(0));
+  CodeAttribs && codAt2 = visit(ctx->expr(1));
+  std::string code = codAt1.code + codAt2.code;
+  TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(0));
+  TypesMgr::TypeId t2 = getTypeDecor(ctx->expr(1));
+
+  std::string oper, operT;
+  std::string addr1 = codAt1.addr;
+  std::string addr2 = codAt2.addr;
+  if (Types.isFloatTy(t1) or Types.isFloatTy(t2)) {
+    addr1 = makeFloat(addr1, t1, t2, code);
+    addr2 = makeFloat(addr2, t2, t1, code);
+    operT = "float";
+    if      (ctx->EQUAL()) oper = "fcmp oeq";
+    else if (ctx->DIFF())  oper = "fcmp une";
+    else if (ctx->LS())    oper = "fcmp olt";
+    else if (ctx->BS())    oper = "fcmp ogt";
+    else if (ctx->LE())    oper = "fcmp ole";
+    else                   oper = "fcmp oge";
+  }
+  else {
+    operT = llvmType(t1);
+    if      (ctx->EQUAL()) oper = "icmp eq";
+    else if (ctx->DIFF())  oper = "icmp ne";
+    else if (ctx->LS())    oper = "icmp slt";
+    else if (ctx->BS())    oper = "icmp sgt";
+    else if (ctx->LE())    oper = "icmp sle";
+    else                   oper = "icmp sge";
+  }
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = " + oper + " " + operT + " " +
+          addr1 + ", " + addr2 + "\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitBoolean(AslParser::BooleanContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAt1 = visit(ctx->expr(0));
+  CodeAttribs && codAt2 = visit(ctx->expr(1));
+  std::string code = codAt1.code + codAt2.code;
+  std::string oper = ctx->AND() ? "and" : "or";
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = " + oper + " i1 " + codAt1.addr + ", " +
+          codAt2.addr + "\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitArrayIndex(AslParser::ArrayIndexContext *ctx) {
+  DEBUG_ENTER();
+  std::string name = ctx->ident()->ID()->getText();
+  TypesMgr::TypeId t = getTypeDecor(ctx->ident());
+  CodeAttribs && codAts2 = visit(ctx->expr());
+  std::string code = codAts2.code;
+  std::string elemAddr = arrayElemAddr(name, t, codAts2.addr, code);
+  std::string elemT = llvmType(Types.getArrayElemType(t));
+  std::string temp = newTemp();
+  code += INDENT_INSTR + temp + " = load " + elemT + ", " + elemT + "* " +
+          elemAddr + "\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitValue(AslParser::ValueContext *ctx) {
+  DEBUG_ENTER();
+  std::string addr;
+  if (ctx->CHARVAL())       addr = std::to_string(charCode(ctx->getText()));
+  else if (ctx->FLOATVAL()) addr = llvmFloat(ctx->getText());
+  else                      addr = ctx->getText();  // INTVAL, true, false
+  CodeAttribs codAts(addr, "", "");
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitExprIdent(AslParser::ExprIdentContext *ctx) {
+  DEBUG_ENTER();
+  CodeAttribs && codAts = visit(ctx->ident());
+  DEBUG_EXIT();
+  return codAts;
+}
+
+antlrcpp::Any LLVMGenVisitor::visitIdent(AslParser::IdentContext *ctx) {
+  DEBUG_ENTER();
+  std::string name = ctx->ID()->getText();
+  TypesMgr::TypeId t = getTypeDecor(ctx);
+  if (Types.isArrayTy(t)) {
+    // arrays have no value of their own: the consumer (a call or a
+    // whole-array assignment) materializes the address it needs
+    CodeAttribs codAts(name, "", "");
+    DEBUG_EXIT();
+    return codAts;
+  }
+  std::string temp = newTemp();
+  std::string code = INDENT_INSTR + temp + " = load " + llvmType(t) + ", " +
+                     llvmType(t) + "* %" + name + ".addr\n";
+  CodeAttribs codAts(temp, "", code);
+  DEBUG_EXIT();
+  return codAts;
+}
+
+
+// Getters for the necessary tree node atributes:
+//   Scope and Type
+SymTable::ScopeId LLVMGenVisitor::getScopeDecor(antlr4::ParserRuleContext *ctx) const {
+  return Decorations.getScope(ctx);
+}
+TypesMgr::TypeId LLVMGenVisitor::getTypeDecor(antlr4::ParserRuleContext *ctx) const {
+  return Decorations.getType(ctx);
+}
+
+
+// Constructor of the class CodeAttribs:
+//
+LLVMGenVisitor::CodeAttribs::CodeAttribs(const std::string & addr,
+                                         const std::string & offs,
+                                         const std::string & code) :
+  addr{addr}, offs{offs}, code{code} {
+}
@@ -0,0 +1,200 @@
+//////////////////////////////////////////////////////////////////////
+//
+//    LLVMGenVisitor - Walk the parser tree to emit LLVM IR
+//                     directly, without t-code in between
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: José Miguel Rivero (rivero@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.110 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+#include "AslBaseVisitor.h"
+
+#include "../common/TypesMgr.h"
+#include "../common/SymTable.h"
+#include "../common/TreeDecoration.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>    // std::size_t
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LLVMGenVisitor: derived from AslBaseVisitor.
+// Sibling of CodeGenVisitor for the --emit-llvm path: it walks the
+// same decorated parse tree (after SymbolsVisitor and TypeCheckVisitor
+// have finished with no semantic error) but emits LLVM IR text
+// directly, instead of building a 'code' object whose textual dump
+// would then be re-parsed and translated by code::dumpLLVM. Each
+// variable or parameter lives in an alloca '%name.addr'; expressions
+// load their operands from those allocas into fresh single-assignment
+// registers, so the emitted module is already in the form the t-code
+// translator could only reach for singly-assigned temporals.
+
+class LLVMGenVisitor final : public AslBaseVisitor {
+
+public:
+
+  // Constructor. With 'bufferedIO' the read/write statements call
+  // the buffered runtime of aslrt.cpp (to be linked with the emitted
+  // module) instead of scanf/printf/putchar
+  LLVMGenVisitor(TypesMgr       & Types,
+                 SymTable       & Symbols,
+                 TreeDecoration & Decorations,
+                 bool             bufferedIO = false);
+
+  // Methods to visit each kind of node:
+  antlrcpp::Any visitProgram(AslParser::ProgramContext *ctx);
+  antlrcpp::Any visitFunction(AslParser::FunctionContext *ctx);
+  antlrcpp::Any visitStatements(AslParser::StatementsContext *ctx);
+  antlrcpp::Any visitAssignStmt(AslParser::AssignStmtContext *ctx);
+  antlrcpp::Any visitIfStmt(AslParser::IfStmtContext *ctx);
+  antlrcpp::Any visitWhileStmt(AslParser::WhileStmtContext *ctx);
+  antlrcpp::Any visitProcCall(AslParser::ProcCallContext *ctx);
+  antlrcpp::Any visitReturnExpr(AslParser::ReturnExprContext *ctx);
+  antlrcpp::Any visitReadStmt(AslParser::ReadStmtContext *ctx);
+  antlrcpp::Any visitWriteExpr(AslParser::WriteExprContext *ctx);
+  antlrcpp::Any visitWriteString(AslParser::WriteStringContext *ctx);
+  antlrcpp::Any visitLeft_expr(AslParser::Left_exprContext *ctx);
+  antlrcpp::Any visitExprIdent(AslParser::ExprIdentContext *ctx);
+  antlrcpp::Any visitUnary(AslParser::UnaryContext *ctx);
+  antlrcpp::Any visitFuncCall(AslParser::FuncCallContext *ctx);
+  antlrcpp::Any visitParenthesis(AslParser::ParenthesisContext *ctx);
+  antlrcpp::Any visitArithmetic(AslParser::ArithmeticContext *ctx);
+  antlrcpp::Any visitRelational(AslParser::RelationalContext *ctx);
+  antlrcpp::Any visitBoolean(AslParser::BooleanContext *ctx);
+  antlrcpp::Any visitArrayIndex(AslParser::ArrayIndexContext *ctx);
+  antlrcpp::Any visitValue(AslParser::ValueContext *ctx);
+  antlrcpp::Any visitIdent(AslParser::IdentContext *ctx);
+
+private:
+
+  // Attributes
+  TypesMgr        & Types;
+  SymTable        & Symbols;
+  TreeDecoration  & Decorations;
+  // Current function type (assigned before visit its instructions)
+  TypesMgr::TypeId currFunctionType;
+  // emit calls into the buffered I/O runtime instead of stdio
+  bool bufferedIO;
+
+  // per-function counters: single-assignment registers and labels
+  unsigned int tempCount;
+  unsigned int labelCount;
+
+  // module-level collections, filled while the functions are visited:
+  //   - the processed string literals of 'write' (globals @.str.s.N)
+  std::vector<std::string> stringLits;
+  //   - which pieces of the C runtime the trailing declares must cover
+  bool usesPrintf;
+  bool usesPutchar;
+  bool usesScanf;
+  bool usesMemcpy;
+  bool usesReadBool;
+  //   - which pieces of the buffered runtime (aslrt.cpp) are called,
+  //     when bufferedIO replaces the stdio calls above
+  bool rtWriteI, rtWriteF, rtWriteC, rtWriteS;
+  bool rtReadI, rtReadF, rtReadC;
+  //   - which format string globals are needed (@.str.i/f/c)
+  bool needFmtI;
+  bool needFmtF;
+  bool needFmtC;
+
+  // Accessor/Mutator to the type (TypeId) of the current function
+  TypesMgr::TypeId getCurrentFunctionTy ()                      const;
+  void             setCurrentFunctionTy (TypesMgr::TypeId type);
+
+  // fresh single-assignment register / fresh label (with a hint of
+  // the construct it belongs to, as clang does: "if.then.3")
+  std::string newTemp  ();
+  std::string newLabel (const std::string & base);
+
+  // the LLVM type of an Asl basic type (i32, float, i8, i1, void)
+  std::string llvmType (TypesMgr::TypeId tid) const;
+  // an LLVM constant of that type equal to zero (for default returns)
+  std::string llvmZero (TypesMgr::TypeId tid) const;
+  // an Asl float literal as an LLVM constant: the decimal text is only
+  // accepted when exactly representable, so print the bits of the
+  // float value widened to double, as clang does
+  static std::string llvmFloat (const std::string & text);
+  // the character code of an Asl char literal (quotes and escapes)
+  static int charCode (const std::string & text);
+
+  // register the processed body of an Asl string literal as a global
+  // @.str.s.N and return the name of that global; 'size' gets its
+  // size in bytes (including the closing \00)
+  std::string addStringLit (const std::string & s, std::size_t & size);
+
+  // emit (into 'code') the loads that turn an array identifier into
+  // the address of its first element: local arrays decay with a
+  // getelementptr, array parameters hold the address in their alloca
+  std::string arrayBaseAddr (const std::string & name,
+                             TypesMgr::TypeId    arrayTy,
+                             std::string       & code);
+  // emit (into 'code') the address of element 'index' of that array
+  std::string arrayElemAddr (const std::string & name,
+                             TypesMgr::TypeId    arrayTy,
+                             const std::string & index,
+                             std::string       & code);
+  // emit (into 'code') the sitofp conversion of 'addr' when the
+  // expected type is float and the value is an integer
+  std::string makeFloat (const std::string & addr,
+                         TypesMgr::TypeId    exprTy,
+                         TypesMgr::TypeId    expectedTy,
+                         std::string       & code);
+
+  // Getters for the necessary tree node atributes:
+  //   Scope and Type
+  SymTable::ScopeId getScopeDecor (antlr4::ParserRuleContext *ctx) const;
+  TypesMgr::TypeId  getTypeDecor  (antlr4::ParserRuleContext *ctx) const;
+
+
+  //////////////////////////////////////////////////////////////////
+  // Class CodeAttribs: same grouping as in CodeGenVisitor, but here
+  // 'addr' is an LLVM value (a register %tN or a constant), 'offs'
+  // is unused except by left_expr (where 'addr' is already the
+  // address of the target cell) and 'code' is the IR text computing
+  // the value.
+  class CodeAttribs {
+
+  public:
+    // Constructor
+    CodeAttribs(const std::string & addr,
+                const std::string & offs,
+                const std::string & code);
+
+    // Attributes (publics):
+    //   - the LLVM value holding the result of an expression
+    std::string addr;
+    //   - unused (kept for symmetry with CodeGenVisitor)
+    std::string offs;
+    //   - the LLVM IR text associated to an statement/expression
+    std::string code;
+
+  };  // class CodeAttribs
+
+};  // class LLVMGenVisitor
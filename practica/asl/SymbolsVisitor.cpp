@@ -59,6 +59,11 @@ SymbolsVisitor::SymbolsVisitor(TypesMgr       & Types,
   Errors{Errors} {
 }
 
+// Mutator for the fused-analysis mode
+void SymbolsVisitor::setDeferDeclarations(bool b) {
+  deferDecls = b;
+}
+
 // Methods to visit each kind of node:
 //
 antlrcpp::Any SymbolsVisitor::visitProgram(AslParser::ProgramContext *ctx) {
@@ -96,8 +101,9 @@ antlrcpp::Any SymbolsVisitor::visitFunction(AslParser::FunctionContext *ctx) {
     lParamsTy.push_back(te);
   }
   
-  //AGREGA LAS DECLARACIONES
-  visit(ctx->declarations());
+  //AGREGA LAS DECLARACIONES (salvo en modo fusionado, que las visita
+  //el driver junto con el typecheck del cuerpo)
+  if (not deferDecls) visit(ctx->declarations());
 
   //BORRA LAS VARIABLES PARA PODER USARLAS DESPUES
   Symbols.popScope();
@@ -82,6 +82,11 @@ public:
   // antlrcpp::Any visitValue(AslParser::ValueContext *ctx);
   // antlrcpp::Any visitIdent(AslParser::IdentContext *ctx);
 
+  // When set, visitFunction registers the function signature and its
+  // parameters but skips the local declarations, which the fused
+  // analysis driver visits later, right before typechecking the body
+  void setDeferDeclarations (bool b);
+
 private:
 
   // Attributes:
@@ -89,6 +94,7 @@ private:
   SymTable       & Symbols;
   TreeDecoration & Decorations;
   SemErrors      & Errors;
+  bool             deferDecls = false;
 
   // Getters for the necessary tree node atributes:
   //   Scope and Type
@@ -71,7 +71,8 @@ antlrcpp::Any TypeCheckVisitor::visitProgram(AslParser::ProgramContext *ctx) {
   DEBUG_ENTER();
   SymTable::ScopeId sc = getScopeDecor(ctx);
   Symbols.pushThisScope(sc);
-  for (auto ctxFunc : ctx->function()) { 
+  for (auto ctxFunc : ctx->function()) {
+    if (Errors.budgetExhausted()) break;
     visit(ctxFunc);
   }
   if (Symbols.noMainProperlyDeclared())
@@ -117,7 +118,12 @@ antlrcpp::Any TypeCheckVisitor::visitFunction(AslParser::FunctionContext *ctx) {
 
 antlrcpp::Any TypeCheckVisitor::visitStatements(AslParser::StatementsContext *ctx) {
   DEBUG_ENTER();
-  visitChildren(ctx);
+  for (auto ctxStmt : ctx->statement()) {
+    // with an error budget (--maxErrors) the traversal is abandoned
+    // as soon as the budget is spent
+    if (Errors.budgetExhausted()) break;
+    visit(ctxStmt);
+  }
   DEBUG_EXIT();
   return 0;
 }
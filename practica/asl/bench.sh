@@ -0,0 +1,160 @@
+#!/bin/bash
+
+# Compile-time benchmark for the asl compiler.
+#
+# Synthesizes ASL programs along the axes the compiler is sensitive to
+# (function count, expression depth, identifiers per scope, array
+# declarations) into bench_tmp/, compiles each one REPS times with
+# --profile, and reports the best total wall time plus the per-phase
+# split of the last run.
+#
+# Usage:
+#   ./bench.sh            compare against bench-baseline.txt (if any)
+#   ./bench.sh --record   save the results as the new baseline
+#
+# Typical use: record a baseline on master, re-run after changing
+# CodeGenVisitor/TypesMgr/..., and look at the deltas.
+
+export LD_LIBRARY_PATH=/usr
+
+REPS=5
+BASELINE=bench-baseline.txt
+MODE=$1
+
+if (test ! -x ./asl); then
+    echo "./asl not found: run 'make asl' first"
+    exit 1
+fi
+
+mkdir -p bench_tmp
+rm -f bench_tmp/tmp.results
+
+#--------------------------------------------
+# generators: each writes one program to stdout
+
+# many small functions (symbol table growth, per-function overheads)
+gen_funcs() {
+    n=$1
+    for i in $(seq 1 $n); do
+	echo "func f$i() : int"
+	echo "  var a, b : int"
+	echo "  a = $i;"
+	echo "  b = a * 2;"
+	echo "  return a + b * 3;"
+	echo "endfunc"
+    done
+    echo "func main()"
+    echo "  var s : int"
+    echo "  s = 0;"
+    for i in $(seq 1 $n); do
+	echo "  s = s + f$i();"
+    done
+    echo "  write s;"
+    echo "endfunc"
+}
+
+# deeply nested expressions (visitor recursion, temporal pressure)
+gen_exprs() {
+    depth=$1
+    echo "func main()"
+    echo "  var a, b, x : int"
+    echo "  a = 1;"
+    echo "  b = 2;"
+    e="a"
+    for i in $(seq 1 $depth); do
+	e="($e + b * $i)"
+    done
+    echo "  x = $e;"
+    echo "  write x;"
+    echo "endfunc"
+}
+
+# many identifiers in one scope (scope stack searches)
+gen_scopes() {
+    n=$1
+    echo "func main()"
+    for i in $(seq 1 $n); do
+	echo "  var x$i : int"
+    done
+    echo "  x1 = 1;"
+    for i in $(seq 2 $n); do
+	echo "  x$i = x$((i-1)) + 1;"
+    done
+    echo "  write x$n;"
+    echo "endfunc"
+}
+
+# many array declarations and element accesses
+gen_arrays() {
+    n=$1
+    echo "func main()"
+    for i in $(seq 1 $n); do
+	echo "  var a$i : array [100] of int"
+    done
+    echo "  var i : int"
+    echo "  i = 0;"
+    echo "  while i < 100 do"
+    for i in $(seq 1 $n); do
+	echo "    a$i[i] = i * $i;"
+    done
+    echo "    i = i + 1;"
+    echo "  endwhile"
+    echo "  write a1[50] + a$n[50];"
+    echo "endfunc"
+}
+
+#--------------------------------------------
+# run one benchmark: compile REPS times, keep the best total
+
+run_bench() {
+    name=$1
+    file=$2
+
+    best=""
+    for rep in $(seq 1 $REPS); do
+	./asl --profile "$file" >/dev/null 2>bench_tmp/tmp.prof
+	if (test $? != 0); then
+	    echo "$name: compilation failed"
+	    return
+	fi
+	total=$(grep -o '"wall_ms": [0-9.]*' bench_tmp/tmp.prof |
+		awk '{s+=$2} END {printf "%.2f", s}')
+	if [ -z "$best" ] || awk "BEGIN{exit !($total < $best)}"; then
+	    best=$total
+	fi
+    done
+    phases=$(grep -o '"name": "[a-z()]*", "wall_ms": [0-9.]*' bench_tmp/tmp.prof |
+	     sed 's/"name": "//; s/",//; s/"wall_ms"://' |
+	     awk '{printf "%s %.1f  ", $1, $2}')
+    echo -n "**** $name: ${best} ms   [$phases]"
+    echo "$name $best" >> bench_tmp/tmp.results
+
+    if [ "$MODE" != "--record" ] && [ -f $BASELINE ]; then
+	base=$(awk -v n=$name '$1 == n {print $2}' $BASELINE)
+	if [ -n "$base" ]; then
+	    awk "BEGIN{printf \"   (baseline %.2f ms, %+.1f%%)\", $base, 100*($best-$base)/$base}"
+	fi
+    fi
+    echo ""
+}
+
+#--------------------------------------------
+
+echo "======================================================="
+echo "=== compile-time benchmarks (best of $REPS runs) ========"
+
+gen_funcs  300 > bench_tmp/bench_funcs.asl
+gen_exprs  200 > bench_tmp/bench_exprs.asl
+gen_scopes 300 > bench_tmp/bench_scopes.asl
+gen_arrays 200 > bench_tmp/bench_arrays.asl
+
+run_bench funcs  bench_tmp/bench_funcs.asl
+run_bench exprs  bench_tmp/bench_exprs.asl
+run_bench scopes bench_tmp/bench_scopes.asl
+run_bench arrays bench_tmp/bench_arrays.asl
+
+if [ "$MODE" == "--record" ]; then
+    mv bench_tmp/tmp.results $BASELINE
+    echo "=== baseline recorded in $BASELINE ==========="
+fi
+echo "======================================================="
@@ -0,0 +1,158 @@
+#!/bin/bash
+
+# Parallel replacement for check-examples.sh.
+#
+# Runs the same jpbasic/jp typecheck and codegen examples, but spreads
+# the cases over all cores and gives each one its own directory under
+# check_tmp/ (the sequential script shared tmp.diff and tmp.err between
+# cases, so they could not overlap). The wall time of every compilation
+# and every tvm execution is recorded; against a recorded baseline,
+# cases whose time grows by more than THRESHOLD% (and by at least
+# MIN_DELTA ms, to ignore jitter on the fastest ones) are flagged, so
+# the suite doubles as a performance tripwire.
+#
+# Usage:
+#   ./check-parallel.sh            run the suite, compare the times
+#                                  against check-times-baseline.txt
+#   ./check-parallel.sh --record   also save the times as the baseline
+#
+# Typical use: 'make check-baseline' on master, then 'make check'
+# after a change and look for "Wrong output" and "TIME REGRESSION".
+
+export LD_LIBRARY_PATH=/usr
+
+JOBS=$(nproc)
+TMPROOT=check_tmp
+BASELINE=check-times-baseline.txt
+THRESHOLD=50	# flag when a time grows more than this percentage ...
+MIN_DELTA=10	# ... and by at least this many milliseconds
+MODE=$1
+
+if (test ! -x ./asl); then
+    echo "./asl not found: run 'make asl' first"
+    exit 1
+fi
+
+rm -rf $TMPROOT
+mkdir -p $TMPROOT
+
+now_ms() {
+    echo $(( $(date +%s%N) / 1000000 ))
+}
+
+#--------------------------------------------
+# one typecheck case: compile, keep the error lines, diff them against
+# the expected .err file; everything stays in the case's own directory
+
+run_chkt_case() {
+    f=$1
+    dir=$TMPROOT/$(basename "$f" .asl)
+    mkdir -p $dir
+
+    t0=$(now_ms)
+    ./asl "$f" 2>&1 | grep '^L' >$dir/err
+    t1=$(now_ms)
+    echo "compile $((t1 - t0))" >$dir/times
+
+    if diff "${f/asl/err}" $dir/err >$dir/diff; then
+	echo "OK" >$dir/result
+    else
+	{ echo "Wrong output"; cat $dir/diff; echo ""; } >$dir/result
+    fi
+}
+
+#--------------------------------------------
+# one codegen case: compile to t-code, run it on tvm with the .in
+# input, diff against the expected .out file
+
+run_genc_case() {
+    f=$1
+    dir=$TMPROOT/$(basename "$f" .asl)
+    mkdir -p $dir
+
+    t0=$(now_ms)
+    ./asl "$f" >$dir/prog.t 2>&1
+    status=$?
+    t1=$(now_ms)
+    echo "compile $((t1 - t0))" >$dir/times
+    if (test $status != 0); then
+	echo "Compilation errors" >$dir/result
+	return
+    fi
+
+    ../tvm/tvm $dir/prog.t < "${f/asl/in}" >$dir/out
+    t2=$(now_ms)
+    echo "execute $((t2 - t1))" >>$dir/times
+
+    if diff "${f/asl/out}" $dir/out >$dir/diff; then
+	echo "OK" >$dir/result
+    else
+	{ echo "Wrong output"; cat $dir/diff; echo ""; } >$dir/result
+    fi
+}
+
+#--------------------------------------------
+# keep at most JOBS cases in flight
+
+schedule() {
+    while (test $(jobs -r | wc -l) -ge $JOBS); do
+	wait -n
+    done
+    "$@" &
+}
+
+#--------------------------------------------
+# after the parallel phase: print the verdicts in the usual order,
+# collect the times and compare them against the baseline
+
+report_case() {
+    f=$1
+    name=$(basename "$f" .asl)
+    dir=$TMPROOT/$name
+
+    echo -n "****" $name.asl "...."
+    cat $dir/result
+
+    while read phase ms; do
+	echo "$name $phase $ms" >>$TMPROOT/times
+	if [ "$MODE" != "--record" ] && [ -f $BASELINE ]; then
+	    base=$(awk -v n=$name -v p=$phase '$1 == n && $2 == p {print $3}' $BASELINE)
+	    if [ -n "$base" ] &&
+	       (test $ms -gt $((base + MIN_DELTA))) &&
+	       (test $((100 * ms)) -gt $(((100 + THRESHOLD) * base))); then
+		echo "     TIME REGRESSION: $phase ${ms} ms (baseline ${base} ms)"
+	    fi
+	fi
+    done <$dir/times
+}
+
+#--------------------------------------------
+
+CHKT=$(ls ../examples/jpbasic_chkt_*.asl ../examples/jp_chkt_*.asl 2>/dev/null)
+GENC=$(ls ../examples/jpbasic_genc_*.asl ../examples/jp_genc_*.asl 2>/dev/null)
+
+echo "======================================================="
+echo "=== running $(echo $CHKT $GENC | wc -w) examples on $JOBS cores"
+
+for f in $CHKT; do
+    schedule run_chkt_case "$f"
+done
+for f in $GENC; do
+    schedule run_genc_case "$f"
+done
+wait
+
+for f in $CHKT $GENC; do
+    report_case "$f"
+done
+
+total=$(echo $CHKT $GENC | wc -w)
+ok=$(grep -lx 'OK' $TMPROOT/*/result 2>/dev/null | wc -l)
+echo "=== $ok/$total OK"
+if [ "$MODE" == "--record" ]; then
+    mv $TMPROOT/times $BASELINE
+    echo "=== per-test times recorded in $BASELINE"
+fi
+echo "======================================================="
+
+test $ok == $total
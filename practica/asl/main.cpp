@@ -38,13 +38,29 @@
 #include "../common/SymTable.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "../common/MmapCharStream.h"
 #include "SymbolsVisitor.h"
 #include "TypeCheckVisitor.h"
 #include "../common/code.h"
+#include "../common/bincode.h"
+#include "../common/codecache.h"
+#include "../common/tvm.h"
+#include "../common/peephole.h"
+#include "../common/profiler.h"
+#include "../common/arena.h"
 #include "CodeGenVisitor.h"
+#include "LLVMGenVisitor.h"
 
 #include <iostream>
 #include <fstream>    // ifstream
+#include <sstream>    // ostringstream
+#include <string>
+#include <vector>
+
+#include <atomic>     // atomic (batch mode)
+#include <memory>     // unique_ptr
+#include <mutex>      // mutex, lock_guard (batch mode)
+#include <thread>     // thread (batch mode)
 
 #include <cstdio>     // fopen
 #include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
@@ -54,45 +70,447 @@
 // using namespace antlr4;
 
 
+// Two-stage parse. Nearly all inputs are syntactically valid, so the
+// first attempt runs the cheap SLL prediction mode with a bail-out
+// error strategy (no recovery machinery, stop at the first mismatch).
+// Only if that fails is the input parsed again with the default
+// full-LL prediction and error reporting, so error messages are
+// exactly the ones the single-stage parser produced.
+static AslParser::ProgramContext* parseProgram(AslParser &parser,
+                                               antlr4::CommonTokenStream &tokens) {
+  parser.getInterpreter<antlr4::atn::ParserATNSimulator>()
+        ->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+  parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+  parser.removeErrorListeners();
+  try {
+    return parser.program();
+  }
+  catch (antlr4::ParseCancellationException &) {
+    // rewind and re-parse with full prediction and error recovery
+    tokens.reset();
+    parser.reset();
+    parser.addErrorListener(&antlr4::ConsoleErrorListener::INSTANCE);
+    parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+    parser.getInterpreter<antlr4::atn::ParserATNSimulator>()
+          ->setPredictionMode(antlr4::atn::PredictionMode::LL);
+    return parser.program();
+  }
+}
+
+
+// Fused semantic analysis: instead of the two full-tree passes
+// (SymbolsVisitor then TypeCheckVisitor), sweep the functions once for
+// their signatures (semantically required, since a body may call a
+// function declared later) and then, per function, collect the local
+// declarations and typecheck the body back to back while that subtree
+// is still hot in memory.
+static void fusedSemanticAnalysis(AslParser::ProgramContext *tree,
+                                  SymbolsVisitor   & symboldecl,
+                                  TypeCheckVisitor & typecheck,
+                                  SymTable         & symbols,
+                                  TreeDecoration   & decorations,
+                                  SemErrors        & errors,
+                                  std::ostream     & os = std::cout) {
+  // sweep 1: function signatures and parameters only
+  symboldecl.setDeferDeclarations(true);
+  symboldecl.visit(tree);
+  // sweep 2: local declarations plus typecheck, function by function
+  symbols.pushThisScope(decorations.getScope(tree));
+  for (auto ctxFunc : tree->function()) {
+    if (errors.budgetExhausted()) break;
+    symbols.pushThisScope(decorations.getScope(ctxFunc));
+    symboldecl.visit(ctxFunc->declarations());
+    symbols.popScope();
+    typecheck.visit(ctxFunc);
+  }
+  if (symbols.noMainProperlyDeclared())
+    errors.noMainProperlyDeclared(tree);
+  symbols.popScope();
+  errors.print(os);
+}
+
+
+// Parallel typecheck: once the SymbolsVisitor has filled the scopes,
+// the function bodies are independent — each one reads the global
+// scope and its own scope, and writes decorations only on its own
+// subtree. Workers take the next pending function from a shared
+// counter; each worker typechecks with a private copy of the symbol
+// table (its scope stack is per-traversal state), an overlay
+// TreeDecoration over the shared one and its own SemErrors buffer.
+// TypesMgr is only read: every type the typecheck can mention has
+// already been interned by the SymbolsVisitor or is a cached basic
+// type. The decorations and errors are merged back on the main thread
+// (print sorts the errors, so the merge order does not matter).
+static void parallelTypeCheck(AslParser::ProgramContext *tree,
+                              TypesMgr       & types,
+                              SymTable       & symbols,
+                              TreeDecoration & decorations,
+                              SemErrors      & errors) {
+  const std::vector<AslParser::FunctionContext*> funcs = tree->function();
+  std::atomic<std::size_t> next(0);
+  unsigned int numWorkers = std::thread::hardware_concurrency();
+  if (numWorkers == 0) numWorkers = 1;
+  if (numWorkers > funcs.size()) numWorkers = funcs.size();
+  std::vector<TreeDecoration> workerDecor;
+  std::vector<SemErrors>      workerErrs(numWorkers);
+  workerDecor.reserve(numWorkers);
+  for (unsigned int w = 0; w < numWorkers; ++w) {
+    workerDecor.emplace_back(&decorations);
+    // each worker gets its own share of the error budget (if any)
+    workerErrs[w].setErrorBudget(errors.getErrorBudget());
+  }
+  std::vector<std::thread> workers;
+  for (unsigned int w = 0; w < numWorkers; ++w) {
+    workers.emplace_back([&, w]() {
+      SymTable workerSymbols(symbols);
+      TypeCheckVisitor typecheck(types, workerSymbols,
+                                 workerDecor[w], workerErrs[w]);
+      workerSymbols.pushThisScope(decorations.getScope(tree));
+      for (std::size_t i = next++; i < funcs.size(); i = next++) {
+        if (workerErrs[w].budgetExhausted()) break;
+        typecheck.visit(funcs[i]);
+      }
+      workerSymbols.popScope();
+    });
+  }
+  for (auto & worker : workers) worker.join();
+  for (unsigned int w = 0; w < numWorkers; ++w) {
+    decorations.absorb(workerDecor[w]);
+    errors.absorb(workerErrs[w]);
+  }
+  if (symbols.noMainProperlyDeclared())
+    errors.noMainProperlyDeclared(tree);
+  errors.print();
+}
+
+
+// Incremental code generation (--incremental): the code generated for
+// each function is kept next to the source together with a hash of
+// the function's source span; a function whose hash is unchanged gets
+// its subroutine spliced from the cache instead of re-visiting its
+// subtree. Calling conventions leak into the caller's code, so a
+// digest of every function signature in the module seeds the
+// per-function hashes: editing a body invalidates one entry, editing
+// any signature invalidates them all.
+static code incrementalCodeGen(AslParser::ProgramContext *tree,
+                               CodeGenVisitor    & codegenerator,
+                               SymTable          & symbols,
+                               TreeDecoration    & decorations,
+                               const std::string & cachePath) {
+  codecache::cachemap cached;
+  codecache::load(cachePath, cached);
+
+  // digest of all the signatures in the module
+  std::string sigs;
+  for (auto ctxFunc : tree->function()) {
+    sigs += ctxFunc->ID()->getText();
+    for (auto par : ctxFunc->parameter_decl())
+      sigs += "(" + par->getText() + ")";
+    if (ctxFunc->basic_type())
+      sigs += ":" + ctxFunc->basic_type()->getText();
+    sigs += ";";
+  }
+  std::uint64_t sigSeed = codecache::hash(sigs);
+
+  code mycode;
+  codecache::cachemap fresh;
+  symbols.pushThisScope(decorations.getScope(tree));
+  for (auto ctxFunc : tree->function()) {
+    std::string name = ctxFunc->ID()->getText();
+    std::uint64_t h = codecache::hash(ctxFunc->getText(), sigSeed);
+    auto hit = cached.find(name);
+    if (hit != cached.end() and hit->second.hash == h) {
+      mycode.add_subroutine(hit->second.sub);
+    }
+    else {
+      subroutine subr = codegenerator.visit(ctxFunc);
+      mycode.add_subroutine(subr);
+    }
+    fresh.emplace(name, codecache::entry{h, mycode.get_last_subroutine()});
+  }
+  symbols.popScope();
+  codecache::write(fresh, cachePath);
+  return mycode;
+}
+
+
+// Compile one file of a batch, end to end, on the calling thread.
+// All per-compilation state is local (or thread-local: the temp/label
+// counters and the operand table), so several files can be compiled
+// concurrently. Diagnostics are collected in 'diag' so the caller can
+// flush them atomically; the generated code goes to <file>.t.
+// Returns false if the file did not compile cleanly.
+static bool compileOneFile(const std::string & fileName,
+                           bool                onlySyntaxOpt,
+                           bool                noCodegenOpt,
+                           std::ostream      & diag) {
+  counters::reset();
+
+  // per-compilation arena: the front-end state built below takes its
+  // node memory from here and it is all returned in one shot when
+  // this function ends, instead of one free per node. The arena is
+  // attached per thread, so concurrent workers do not share it
+  arena frontendArena;
+  arena::scope arenaScope(frontendArena);
+
+  // map the source and lex it in place (the page cache is shared
+  // between the workers); fall back to the stream path if the file
+  // cannot be mapped
+  MmapCharStream mappedInput(fileName);
+  antlr4::ANTLRInputStream streamInput;
+  antlr4::CharStream *input = &mappedInput;
+  if (not mappedInput.valid()) {
+    std::ifstream stream(fileName);
+    if (not stream) {
+      diag << "No such file: " << fileName << std::endl;
+      return false;
+    }
+    streamInput = antlr4::ANTLRInputStream(stream);
+    input = &streamInput;
+  }
+  AslLexer lexer(input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  AslParser parser(&tokens);
+  AslParser::ProgramContext *tree = parseProgram(parser, tokens);
+
+  if (lexer.getNumberOfSyntaxErrors() > 0 or
+      parser.getNumberOfSyntaxErrors() > 0) {
+    diag << fileName << ": Lexical and/or syntactical errors have been found." << std::endl;
+    return false;
+  }
+  if (onlySyntaxOpt) return true;
+
+  TypesMgr       types;
+  SymTable       symbols(types);
+  TreeDecoration decorations;
+  SemErrors      errors;
+  SymbolsVisitor   symboldecl(types, symbols, decorations, errors);
+  TypeCheckVisitor typecheck(types, symbols, decorations, errors);
+  // the fused driver is used here because it reports the errors through
+  // the given stream (the default two-pass pipeline prints to std::cout,
+  // which would interleave between worker threads)
+  std::ostringstream semErrOut;
+  fusedSemanticAnalysis(tree, symboldecl, typecheck,
+                        symbols, decorations, errors, semErrOut);
+  if (errors.getNumberOfSemanticErrors() > 0) {
+    diag << fileName << ":" << std::endl << semErrOut.str()
+         << "There are semantic errors: no code generated." << std::endl;
+    return false;
+  }
+  if (noCodegenOpt) return true;
+
+  CodeGenVisitor codegenerator(types, symbols, decorations);
+  code mycode = codegenerator.visit(tree);
+
+  // write the generated code next to the source: foo.asl -> foo.t
+  std::string outName = fileName;
+  std::size_t dotPos = outName.rfind(".");
+  if (dotPos != std::string::npos and outName.substr(dotPos) == ".asl")
+    outName.erase(dotPos);
+  outName += ".t";
+  std::ofstream out(outName);
+  if (not out) {
+    diag << fileName << ": cannot write " << outName << std::endl;
+    return false;
+  }
+  mycode.dump(out);    // streamed: no whole-program string is built
+  out << std::endl;
+  return true;
+}
+
+
+// Compile a set of files concurrently, one worker thread per core.
+// Workers take the next pending file from a shared counter; diagnostics
+// of each file are printed atomically once the file is done.
+static int runBatch(const std::vector<std::string> & files,
+                    bool onlySyntaxOpt, bool noCodegenOpt) {
+  std::atomic<std::size_t> next(0);
+  std::atomic<bool>        allOk(true);
+  std::mutex               outputMutex;
+  unsigned int numWorkers = std::thread::hardware_concurrency();
+  if (numWorkers == 0) numWorkers = 1;
+  if (numWorkers > files.size()) numWorkers = files.size();
+  std::vector<std::thread> workers;
+  for (unsigned int w = 0; w < numWorkers; ++w) {
+    workers.emplace_back([&]() {
+      for (std::size_t i = next++; i < files.size(); i = next++) {
+        std::ostringstream diag;
+        if (not compileOneFile(files[i], onlySyntaxOpt, noCodegenOpt, diag))
+          allOk = false;
+        if (not diag.str().empty()) {
+          std::lock_guard<std::mutex> lock(outputMutex);
+          std::cout << diag.str();
+        }
+      }
+    });
+  }
+  for (auto & worker : workers) worker.join();
+  return allOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+// Persistent compile-server mode (--server): stay resident and read
+// one compile request per line from stdin (the path of an .asl file),
+// writing each result to <file>.t. The ATN/DFA caches are static in
+// the generated lexer/parser, so they stay warm across requests and
+// only the first request pays the cold-start cost; compileOneFile
+// already resets the per-compilation counters between jobs. A reply is
+// the diagnostics of the file followed by a status line "ok <file>" or
+// "error <file>" and a blank line, so a client on the other end of a
+// pipe can tell where the reply ends. A line "quit" (or EOF) ends the
+// session.
+static int runServer(bool onlySyntaxOpt, bool noCodegenOpt) {
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (line.empty()) continue;
+    if (line == "quit") break;
+    std::ostringstream diag;
+    bool ok = compileOneFile(line, onlySyntaxOpt, noCodegenOpt, diag);
+    std::cout << diag.str()
+              << (ok ? "ok " : "error ") << line << std::endl
+              << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
+
+
 int main(int argc, const char* argv[]) {
-  // early stop options
-  bool onlySyntaxOpt  = (argc > 1 and std::strcmp(argv[1], "--onlySyntax") == 0);
-  bool onlySyntaxOpt2 = (argc > 2 and std::strcmp(argv[2], "--onlySyntax") == 0);
-  bool noCodegenOpt   = (argc > 1 and std::strcmp(argv[1], "--noCodegen")  == 0);
-  bool noCodeGenOpt2  = (argc > 2 and std::strcmp(argv[2], "--noCodegen")  == 0);
+  // options and input file
+  bool onlySyntaxOpt    = false;
+  bool noCodegenOpt     = false;
+  bool fusedAnalysisOpt = false;
+  bool parallelCheckOpt = false;
+  bool batchOpt         = false;
+  bool serverOpt        = false;
+  bool runOpt           = false;
+  bool optimizeOpt      = false;
+  bool recycleTempsOpt  = false;
+  bool fuseCopiesOpt    = false;
+  bool bufferedIOOpt    = false;
+  bool emitLLVMOpt      = false;
+  bool emitBinaryOpt    = false;
+  bool incrementalOpt   = false;
+  bool profileOpt       = false;
+  bool streamErrorsOpt  = false;
+  int  maxErrorsOpt     = 0;       // 0 = unlimited
+  std::vector<std::string> inputFiles;
+  bool badUsage         = false;
+  for (int i = 1; i < argc; ++i) {
+    if      (std::strcmp(argv[i], "--onlySyntax")    == 0) onlySyntaxOpt    = true;
+    else if (std::strcmp(argv[i], "--noCodegen")     == 0) noCodegenOpt     = true;
+    else if (std::strcmp(argv[i], "--fusedAnalysis") == 0) fusedAnalysisOpt = true;
+    else if (std::strcmp(argv[i], "--parallelTypecheck") == 0) parallelCheckOpt = true;
+    else if (std::strcmp(argv[i], "--batch")         == 0) batchOpt         = true;
+    else if (std::strcmp(argv[i], "--server")        == 0) serverOpt        = true;
+    else if (std::strcmp(argv[i], "--run")           == 0) runOpt           = true;
+    else if (std::strcmp(argv[i], "-O")              == 0) optimizeOpt      = true;
+    else if (std::strcmp(argv[i], "--recycleTemps")  == 0) recycleTempsOpt  = true;
+    else if (std::strcmp(argv[i], "--fuseArrayCopies") == 0) fuseCopiesOpt  = true;
+    else if (std::strcmp(argv[i], "--bufferedIO")    == 0) bufferedIOOpt    = true;
+    else if (std::strcmp(argv[i], "--emit-llvm")     == 0) emitLLVMOpt      = true;
+    else if (std::strcmp(argv[i], "--emit-binary")   == 0) emitBinaryOpt    = true;
+    else if (std::strcmp(argv[i], "--incremental")   == 0) incrementalOpt   = true;
+    else if (std::strcmp(argv[i], "--profile")       == 0) profileOpt       = true;
+    else if (std::strcmp(argv[i], "--streamErrors")  == 0) streamErrorsOpt  = true;
+    else if (std::strncmp(argv[i], "--maxErrors=", 12) == 0) {
+      maxErrorsOpt = std::atoi(argv[i] + 12);
+      if (maxErrorsOpt <= 0) badUsage = true;
+    }
+    else if (argv[i][0] == '-')                            badUsage         = true;
+    else                                                   inputFiles.push_back(argv[i]);
+  }
   // check options and correct use of the program
-  if (argc > 3 or onlySyntaxOpt2 or noCodeGenOpt2 or
-      (argc == 3 and not onlySyntaxOpt and not noCodegenOpt)) {
-    std::cout << "Usage: ./asl [--onlySyntax|--noCodegen] [<file>]" << std::endl;
+  if (serverOpt and (batchOpt or not inputFiles.empty())) badUsage = true;
+  if (emitLLVMOpt and (runOpt or emitBinaryOpt)) badUsage = true;
+  if (bufferedIOOpt and not emitLLVMOpt) badUsage = true;
+  if (fusedAnalysisOpt and parallelCheckOpt) badUsage = true;
+  if (badUsage or (not batchOpt and inputFiles.size() > 1)) {
+    std::cout << "Usage: ./asl [--onlySyntax|--noCodegen|--run|--emit-llvm [--bufferedIO]|--emit-binary] [-O] [--fuseArrayCopies] [--fusedAnalysis|--parallelTypecheck] [--incremental] [--maxErrors=<n>] [--streamErrors] [--profile] [<file>]" << std::endl;
+    std::cout << "       ./asl --batch [--onlySyntax|--noCodegen] <list.txt> | <file>..." << std::endl;
+    std::cout << "       ./asl --server [--onlySyntax|--noCodegen]" << std::endl;
     return EXIT_FAILURE;
   }
-  if (argc == 3 or (argc == 2 and not onlySyntaxOpt and not noCodegenOpt)) {
-    if (not std::fopen(argv[argc-1], "r")) {
-      std::cout << "No such file: " << argv[argc-1] << std::endl;
+
+  if (serverOpt)
+    return runServer(onlySyntaxOpt, noCodegenOpt);
+
+  if (batchOpt) {
+    // a single argument is taken as a list of files (one per line);
+    // several arguments are the files themselves
+    std::vector<std::string> files = inputFiles;
+    if (files.size() == 1) {
+      std::ifstream list(files[0]);
+      if (not list) {
+        std::cout << "No such file: " << files[0] << std::endl;
+        return EXIT_FAILURE;
+      }
+      files.clear();
+      std::string line;
+      while (std::getline(list, line))
+        if (not line.empty()) files.push_back(line);
+    }
+    if (files.empty()) {
+      std::cout << "Empty batch: nothing to compile." << std::endl;
+      return EXIT_FAILURE;
+    }
+    return runBatch(files, onlySyntaxOpt, noCodegenOpt);
+  }
+
+  // per-phase timing and counters, reported as JSON on stderr at the
+  // end (stderr, so the generated code on stdout stays clean)
+  if (profileOpt) profiler::enable();
+
+  const char* inputFile = inputFiles.empty() ? nullptr : inputFiles[0].c_str();
+
+  // a binary program needs no front-end at all: map it and run it
+  if (runOpt and inputFile != nullptr) {
+    std::string name(inputFile);
+    if (name.size() > 3 and name.substr(name.size()-3) == ".tb") {
+      code mycode = bincode::load(name);
+      tvm vm(mycode);
+      return vm.run();
+    }
+  }
+
+  if (inputFile != nullptr) {
+    if (not std::fopen(inputFile, "r")) {
+      std::cout << "No such file: " << inputFile << std::endl;
       return EXIT_FAILURE;
     }
   }
 
-  // open input file (or std::cin) and create a character stream
-  antlr4::ANTLRInputStream input;
-  if ((argc == 3) or (argc == 2 and not onlySyntaxOpt and not noCodegenOpt)) {  // read from <file>
+  // open input file (or std::cin) and create a character stream.
+  // A regular file is memory-mapped and lexed in place, with no
+  // up-front copy; stdin (or a file that cannot be mapped) goes
+  // through ANTLRInputStream as before
+  MmapCharStream mappedInput(inputFile != nullptr ? inputFile : "");
+  antlr4::ANTLRInputStream streamInput;
+  antlr4::CharStream *input;
+  if (inputFile != nullptr and mappedInput.valid()) {
+    input = &mappedInput;
+  }
+  else if (inputFile != nullptr) {  // read from <file>
     std::ifstream stream;
-    stream.open(argv[argc-1]);
-    input = antlr4::ANTLRInputStream(stream);
+    stream.open(inputFile);
+    streamInput = antlr4::ANTLRInputStream(stream);
+    input = &streamInput;
   }
   else {            // read fron std::cin
-    input = antlr4::ANTLRInputStream(std::cin);
+    streamInput = antlr4::ANTLRInputStream(std::cin);
+    input = &streamInput;
   }
 
   // create a lexer that consumes the character stream and produces a token stream
-  AslLexer lexer(&input);
+  AslLexer lexer(input);
   antlr4::CommonTokenStream tokens(&lexer);
 
   // create a parser that consumes the token stream, and parses it.
   AslParser parser(&tokens);
 
   // call the parser and get the parse tree
-  antlr4::tree::ParseTree *tree = parser.program();
+  profiler::phase_begin("parse");
+  AslParser::ProgramContext *tree = parseProgram(parser, tokens);
+  profiler::phase_end();
 
   // check for lexical or syntactical errors
   if (lexer.getNumberOfSyntaxErrors() > 0 or
@@ -109,22 +527,58 @@ int main(int argc, const char* argv[]) {
     return EXIT_SUCCESS;
   }
   
+  // per-compilation arena for the front-end state below (freed in one
+  // shot at exit). Not attached with --parallelTypecheck: the workers
+  // would bump one shared arena concurrently
+  arena frontendArena;
+  std::unique_ptr<arena::scope> arenaScope;
+  if (not parallelCheckOpt)
+    arenaScope.reset(new arena::scope(frontendArena));
+
   // auxililary classes we are going to need to store information while
   // traversing the tree. They are described below in this document
   TypesMgr       types;
   SymTable       symbols(types);
   TreeDecoration decorations;
   SemErrors      errors;
+  // fast-fail options for broken inputs: stop the typecheck after n
+  // errors, and/or print each error as it is found instead of
+  // buffering and sorting the whole list
+  if (maxErrorsOpt > 0) errors.setErrorBudget(maxErrorsOpt);
+  if (streamErrorsOpt)  errors.setStreaming(std::cout);
 
   // create a visitor that looks for variables and function declarations
   // in the tree and stores required information
   SymbolsVisitor symboldecl(types, symbols, decorations, errors);
-  symboldecl.visit(tree);
 
   // create another visitor that will perform type checkings wherever
   // it is needed (on expressions, assignments, parameter passing, etc)
   TypeCheckVisitor typecheck(types, symbols, decorations, errors);
-  typecheck.visit(tree);
+
+  if (fusedAnalysisOpt) {
+    // single interleaved sweep over the functions (see above)
+    profiler::phase_begin("semantic(fused)");
+    fusedSemanticAnalysis(tree, symboldecl, typecheck,
+                          symbols, decorations, errors);
+    profiler::phase_end();
+  }
+  else if (parallelCheckOpt) {
+    // function bodies typechecked concurrently (see above)
+    profiler::phase_begin("symbols");
+    symboldecl.visit(tree);
+    profiler::phase_end();
+    profiler::phase_begin("typecheck(parallel)");
+    parallelTypeCheck(tree, types, symbols, decorations, errors);
+    profiler::phase_end();
+  }
+  else {
+    profiler::phase_begin("symbols");
+    symboldecl.visit(tree);
+    profiler::phase_end();
+    profiler::phase_begin("typecheck");
+    typecheck.visit(tree);
+    profiler::phase_end();
+  }
 
   if (errors.getNumberOfSemanticErrors() > 0) {
     std::cout << "There are semantic errors: no code generated." << std::endl;
@@ -136,13 +590,84 @@ int main(int argc, const char* argv[]) {
     return EXIT_SUCCESS;
   }
   
+  if (emitLLVMOpt) {
+    // emit LLVM IR straight from the decorated tree: no 'code' object
+    // is built and no t-code text is re-parsed by code::dumpLLVM.
+    // With --bufferedIO the read/write statements call the buffered
+    // runtime (link the module with ../common/aslrt.cpp)
+    profiler::phase_begin("llvmgen");
+    LLVMGenVisitor llvmgenerator(types, symbols, decorations, bufferedIOOpt);
+    std::string llvmIR = llvmgenerator.visit(tree);
+    std::cout << llvmIR;
+    profiler::phase_end();
+    if (profileOpt) profiler::report(std::cerr);
+    return EXIT_SUCCESS;
+  }
+
   // create a third visitor that will return the generated code
   // for each part of the tree, and will store it in 'mycode'
   CodeGenVisitor codegenerator(types, symbols, decorations);
-  code mycode = codegenerator.visit(tree);
+  code mycode;
+  profiler::phase_begin("codegen");
+  if (incrementalOpt and inputFile != nullptr) {
+    // the cache sits next to the source: foo.asl -> foo.tcache
+    std::string cacheName = inputFile;
+    std::size_t dotPos = cacheName.rfind(".");
+    if (dotPos != std::string::npos and cacheName.substr(dotPos) == ".asl")
+      cacheName.erase(dotPos);
+    cacheName += ".tcache";
+    mycode = incrementalCodeGen(tree, codegenerator,
+                                symbols, decorations, cacheName);
+  }
+  else {
+    mycode = codegenerator.visit(tree);
+  }
+  profiler::phase_end();
+
+  // local optimization of the generated code (-O)
+  profiler::phase_begin("optimize");
+
+  // whole-array copy loops become single acopy instructions, run on
+  // the pristine generated code so the pattern is intact. Opt-in:
+  // external consumers of the textual dump do not know the opcode
+  // (--run, --emit-llvm and --emit-binary all do)
+  if (fuseCopiesOpt) peephole::fuse_array_copies(mycode);
+
+  if (optimizeOpt) peephole::optimize(mycode);
+
+  // temporal reuse shrinks the frames, but breaks the single
+  // assignment per temporal that dumpLLVM requires, so it has its
+  // own flag
+  if (recycleTempsOpt) peephole::recycle_temps(mycode);
+  profiler::phase_end();
+
+  if (runOpt) {
+    // execute the program in process instead of dumping its text
+    // form for an external interpreter
+    if (profileOpt) profiler::report(std::cerr);
+    tvm vm(mycode);
+    return vm.run();
+  }
+
+  if (emitBinaryOpt) {
+    // write the binary form next to the source: foo.asl -> foo.tb
+    std::string outName = inputFile != nullptr ? inputFile : "output.asl";
+    std::size_t dotPos = outName.rfind(".");
+    if (dotPos != std::string::npos and outName.substr(dotPos) == ".asl")
+      outName.erase(dotPos);
+    outName += ".tb";
+    bincode::write(mycode, outName);
+    if (profileOpt) profiler::report(std::cerr);
+    return EXIT_SUCCESS;
+  }
 
-  // print generated code as output
-  std::cout << mycode.dump() << std::endl;
+  // print generated code as output (streamed: no whole-program
+  // string is built, however large the program)
+  profiler::phase_begin("output");
+  mycode.dump(std::cout);
+  std::cout << std::endl;
+  profiler::phase_end();
+  if (profileOpt) profiler::report(std::cerr);
 
   // uncomment the following lines to generate LLVM code
   // and write it to a .ll file
@@ -105,11 +105,12 @@ const std::map<instruction::Operation, std::string> LLVMCodeGen::tcode2llvmInstr
 };
 
 
-LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode)
+LLVMCodeGen::LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+                         bool promoteRegisters)
   : Types{Types}, Symbols{Symbols}, tCode{tCode},
     writeI(false), writeF(false), writeC(false), writeLN(false),
     readI(false), readF(false), readC(false),
-    haltAndExit(false),
+    haltAndExit(false), useMemcpy(false), promoteRegs(promoteRegisters),
     globalI(false), globalF(false), globalC(false)
 {
   std::string failFunc, failTempVar;
@@ -149,6 +150,7 @@ void LLVMCodeGen::check_SSA_tCode(std::string & failFunc, std::string & failTemp
       case instruction::_WRITES:
       case instruction::_WRITELN:
       case instruction::_NOOP:
+      case instruction::_ACOPY:
       case instruction::_INVALID:
         break;
       default:                 // Except in instruction::_POP, where is optional (arg1 may be ""),
@@ -187,6 +189,11 @@ bool LLVMCodeGen::isTCodeIdentifier(const std::string & tcodeArg) const {
   return true;
 }
 
+bool LLVMCodeGen::isPromotedParam(const std::string & tcodeArg) const {
+  return std::find(promotedParams.begin(), promotedParams.end(), tcodeArg)
+         != promotedParams.end();
+}
+
 void LLVMCodeGen::computeReadWriteHaltInfo() {
   for (auto & subr: tCode.get_subroutine_list()) {
     for (auto & instr: subr.get_instructions()) {
@@ -230,6 +237,9 @@ void LLVMCodeGen::computeReadWriteHaltInfo() {
       case instruction::_HALT:
 	haltAndExit = true;
 	break;
+      case instruction::_ACOPY:
+        useMemcpy = true;
+        break;
       default:
         break;
       }
@@ -241,6 +251,53 @@ void LLVMCodeGen::startNewFunction(const subroutine & subr) {
   currentFunctionName = subr.get_name();
   isMain = (currentFunctionName == "main");
   prevInstrIsTerminator = false;
+  computePromotedParams(subr);
+}
+
+void LLVMCodeGen::computePromotedParams(const subroutine & subr) {
+  // A scalar parameter the function body never writes needs no alloca:
+  // its incoming argument register already holds its only value for
+  // the whole function, so every read can use it directly. Array
+  // parameters are excluded (their alloca holds the passed address)
+  // and so is '_result' (written by definition).
+  promotedParams.clear();
+  if (not promoteRegs) return;
+  std::vector<std::string> written;
+  for (auto & instr : subr.get_instructions()) {
+    switch (instr.oper) {
+    case instruction::_LABEL:
+    case instruction::_UJUMP:
+    case instruction::_FJUMP:
+    case instruction::_HALT:
+    case instruction::_PUSH:
+    case instruction::_RETURN:
+    case instruction::_XLOAD:
+    case instruction::_CLOAD:
+    case instruction::_WRITEI:
+    case instruction::_WRITEF:
+    case instruction::_WRITEC:
+    case instruction::_WRITES:
+    case instruction::_WRITELN:
+    case instruction::_NOOP:
+    case instruction::_ACOPY:
+    case instruction::_INVALID:
+      break;
+    default:     // the same writing positions check_SSA_tCode counts
+      {
+        std::string arg1 = getTCodeArg(instr, 1);
+        if (isTCodeIdentifier(arg1))
+          written.push_back(arg1);
+        break;
+      }
+    }
+  }
+  for (auto & p : subr.params) {
+    if (p.name == "_result") continue;
+    std::string llvmType = getLocalSymbolLLVMType(subr.get_name(), p.name, true);
+    if (isPointerType(llvmType)) continue;
+    if (std::find(written.begin(), written.end(), p.name) == written.end())
+      promotedParams.push_back(p.name);
+  }
 }
 
 void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
@@ -260,7 +317,7 @@ void LLVMCodeGen::bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr) {
     std::string llvmType = getLocalSymbolLLVMType(funcName, varlocal.name);
     bindTCodeLocalValueWithType(varlocal.name, llvmType);
   }
-  for (auto instr : subr.get_instructions()) {
+  for (auto & instr : subr.get_instructions()) {
     std::string arg1 = getTCodeArg(instr, 1);
     std::string arg2 = getTCodeArg(instr, 2);
     std::string arg3 = getTCodeArg(instr, 3);
@@ -690,7 +747,10 @@ void LLVMCodeGen::generateReadWriteHaltBeginEndCode(std::string & begin, std::st
   if (haltAndExit) {
     end += "declare dso_local void @exit(i32) noreturn nounwind\n";
   }
-  if (writeI or writeF or writeC or writeS or writeLN or readI or readF or readC or haltAndExit)
+  if (useMemcpy) {
+    end += "declare void @llvm.memcpy.p0i8.p0i8.i64(i8* noalias nocapture writeonly, i8* noalias nocapture readonly, i64, i1 immarg)\n";
+  }
+  if (writeI or writeF or writeC or writeS or writeLN or readI or readF or readC or haltAndExit or useMemcpy)
     end += "\n";
 }
 
@@ -754,6 +814,7 @@ std::string LLVMCodeGen::dumpAllocaParams(const subroutine & subr) {
   std::string llvmCode;
   std::string funcName = subr.get_name();
   for (auto p : subr.params) {
+    if (isPromotedParam(p.name)) continue;
     std::string llvmValue = getLLVMValue(p.name);
     std::string llvmType;
     if (p.name == "_result")
@@ -800,7 +861,7 @@ std::string LLVMCodeGen::dumpStoreParams(const subroutine & subr) {
     llvmCode += llvmComment("params initialization:");
   }
   for (auto p : subr.params) {
-    if (p.name != "_result") {
+    if (p.name != "_result" and not isPromotedParam(p.name)) {
       std::string llvmValue     = getLLVMValue(p.name);
       std::string llvmValueAddr = getLLVMValueAddr(llvmValue);
       llvmCode += createSTORE(llvmValue, llvmValueAddr);
@@ -811,8 +872,8 @@ std::string LLVMCodeGen::dumpStoreParams(const subroutine & subr) {
 
 std::string LLVMCodeGen::dumpInstructionList(const subroutine & subr) {
   std::string llvmCode;
-  int n = subr.get_instructions().size();
-  instructionList instrList = subr.get_instructions();
+  const instructionList & instrList = subr.get_instructions();
+  int n = instrList.size();
   for (int i = 0; i < n-1; ++i) {
     llvmCode += llvmComment(instrList[i].dump());
     llvmCode += dumpInstruction(instrList[i], instrList[i+1]);
@@ -888,24 +949,24 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
         llvmCode += llvmMemCodeValue2;
         llvmCode += createSTORE(llvmValue2, llvmValue1Addr);
       }
-      else if (isTCodeIdentifier(tcodeArg2)) {   // %4 = a
+      else if (isTCodeIdentifier(tcodeArg2) and not isPromotedParam(tcodeArg2)) {   // %4 = a
         std::string llvmValue2Addr = getLLVMValueAddr(llvmValue2);
         llvmCode += createLOAD(llvmValue1, llvmValue2Addr);
       }
-      else {      // %4 = %6
+      else {      // %4 = %6, or %4 = a with 'a' promoted to a register
         std::string llvmType = getLLVMTypeOfValue(llvmValue2);
         if (isLLVMAnyIntegerType(llvmType)) {
           std::string llvmTypeOneIntUp = getLLVMTypeOneIntUp(llvmType);
           std::string newValuePrefix = "%.temp." + tcodeArg1.substr(1) + "." + llvmTypeOneIntUp;
           std::string llvmValue2Extended = createNewPrefixedValueWithType(newValuePrefix, llvmTypeOneIntUp);
-          llvmCode += createCONVERSION(LLVM_ZEXT, llvmValue2Extended, llvmValue2, llvmTypeOneIntUp);
-          llvmCode += createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2Extended, llvmType);
+          llvmCode += createCONVERSION(LLVM_ZEXT, llvmValue2Extended, llvmValue2, llvmType);
+          llvmCode += createCONVERSION(LLVM_TRUNC, llvmValue1, llvmValue2Extended, llvmTypeOneIntUp);
         }
         else {  // llvmType == LLVM_FLOAT
           std::string newValuePrefix = "%.temp." + tcodeArg1.substr(1) + ".double";
           std::string llvmValue2FPDouble = createNewPrefixedValueWithType(newValuePrefix, LLVM_DOUBLE);
-          llvmCode += createCONVERSION(LLVM_FPEXT, llvmValue2FPDouble, llvmValue2, LLVM_DOUBLE);
-          llvmCode += createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2FPDouble, llvmType);
+          llvmCode += createCONVERSION(LLVM_FPEXT, llvmValue2FPDouble, llvmValue2, llvmType);
+          llvmCode += createCONVERSION(LLVM_FPTRUNC, llvmValue1, llvmValue2FPDouble, LLVM_DOUBLE);
         }
       }
       break;
@@ -1068,6 +1129,13 @@ std::string LLVMCodeGen::dumpInstruction(const instruction & instr,
         llvmCode += createLOAD(llvmValue1, llvmValue2Addr);
       break;
     }
+  case instruction::_ACOPY:
+    {
+      llvmValue1 = getLLVMValue(tcodeArg1);
+      llvmValue2 = getLLVMValue(tcodeArg2);
+      llvmCode += createMEMCPY(llvmValue1, llvmValue2, std::stol(tcodeArg3));
+      break;
+    }
     /*
   case instruction::_LOADC:
     {
@@ -1558,6 +1626,43 @@ std::string LLVMCodeGen::createGETELEMENTPTR(const std::string & llvmArrayPointe
   return llvmCode;
 }
 
+std::string LLVMCodeGen::createMEMCPY(const std::string & llvmValue1,
+                                      const std::string & llvmValue2, long nElems) {
+  std::string llvmCode;
+  std::string llvmType1 = getLLVMTypeOfValue(llvmValue1);
+  std::string llvmElemType;
+  if (isLLVMArrayType(llvmType1))
+    llvmElemType = getLLVMElementOfArrayType(llvmType1);
+  else
+    llvmElemType = getPointedType(llvmType1);
+  std::string llvmElemTypePtr = getPointerToType(llvmElemType);
+  // element pointers of the destination and source: a local array is
+  // addressed through its alloca, a by-reference array parameter holds
+  // the address in its alloca and is loaded first (as in _ALOAD)
+  std::string llvmDst = createNewPrefixedValueWithType("%.cpy.dst", llvmElemTypePtr);
+  std::string llvmValue1Addr = getLLVMValueAddr(llvmValue1);
+  if (isLLVMArrayType(llvmType1))
+    llvmCode += createGETELEMENTPTR(llvmDst, llvmValue1Addr, LLVM_ZERO_INT);
+  else
+    llvmCode += createLOAD(llvmDst, llvmValue1Addr);
+  std::string llvmType2 = getLLVMTypeOfValue(llvmValue2);
+  std::string llvmSrc = createNewPrefixedValueWithType("%.cpy.src", llvmElemTypePtr);
+  std::string llvmValue2Addr = getLLVMValueAddr(llvmValue2);
+  if (isLLVMArrayType(llvmType2))
+    llvmCode += createGETELEMENTPTR(llvmSrc, llvmValue2Addr, LLVM_ZERO_INT);
+  else
+    llvmCode += createLOAD(llvmSrc, llvmValue2Addr);
+  // the intrinsic takes byte pointers and a byte count (i8 and i1
+  // elements take one byte each in the alloca, the rest take four)
+  std::string llvmDstI8 = createNewPrefixedValueWithType("%.cpy.dst.i8", LLVM_CHAR_PTR);
+  std::string llvmSrcI8 = createNewPrefixedValueWithType("%.cpy.src.i8", LLVM_CHAR_PTR);
+  llvmCode += INDENT_INSTR + llvmDstI8 + " = bitcast " + llvmElemTypePtr + " " + llvmDst + " to " + LLVM_CHAR_PTR + "\n";
+  llvmCode += INDENT_INSTR + llvmSrcI8 + " = bitcast " + llvmElemTypePtr + " " + llvmSrc + " to " + LLVM_CHAR_PTR + "\n";
+  long nBytes = nElems * ((llvmElemType == LLVM_CHAR or llvmElemType == LLVM_BOOL) ? 1 : 4);
+  llvmCode += INDENT_INSTR + "call void @llvm.memcpy.p0i8.p0i8.i64(i8* " + llvmDstI8 + ", i8* " + llvmSrcI8 + ", i64 " + std::to_string(nBytes) + ", i1 false)\n";
+  return llvmCode;
+}
+
 
 void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn,
                                         std::string & llvmValueOut, std::string & llvmAccInstr) {
@@ -1574,7 +1679,7 @@ void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn,
   //       if tcodeArgIn is a tcode temporal or a constant then:
   //          * llmValueOut is the llvm value corresponding to tcodeArgIn
   //          * no additional instruction is needed (llvmAccInstr is equal to "")
-  if (isTCodeIdentifier(tcodeArgIn)) {
+  if (isTCodeIdentifier(tcodeArgIn) and not isPromotedParam(tcodeArgIn)) {
     std::string llvmValueIn     = getLLVMValue(tcodeArgIn);
     std::string llvmType        = getLLVMTypeOfValue(llvmValueIn);
     std::string llvmValueInAddr = getLLVMValueAddr(llvmValueIn);
@@ -1582,7 +1687,7 @@ void LLVMCodeGen::accessValueOfArgument(const std::string & tcodeArgIn,
     llvmAccInstr = createLOAD(llvmValueOut, llvmValueInAddr);
   }
   else {
-    llvmValueOut = getLLVMValue(tcodeArgIn);  // = tcodeArgIn;
+    llvmValueOut = getLLVMValue(tcodeArgIn);  // = tcodeArgIn, or the argument register itself
     llvmAccInstr = "";
   }
 }
@@ -87,12 +87,17 @@ class LLVMCodeGen {
   bool writeI, writeF, writeC, writeS, writeLN;
   bool readI, readF, readC;
   bool haltAndExit;
+  bool useMemcpy;
+  bool promoteRegs;
   bool globalI, globalF, globalC, globalS;
   std::vector<std::string>            writeSAslStrVec;
   std::vector<std::string::size_type> writeSLLVMStrSizeVec;
   std::string currentFunctionName;
   bool isMain;
   bool prevInstrIsTerminator;
+  // scalar parameters of the current function promoted to their
+  // incoming argument register (see computePromotedParams)
+  std::vector<std::string>           promotedParams;
   std::vector<std::string>           llvmLocalValueVec;
   std::map<std::string, std::string> llvmLocalValueTypeMap;
   std::vector<std::string>           llvmGlobalValueVec;
@@ -106,6 +111,7 @@ class LLVMCodeGen {
   void check_SSA_tCode(std::string & failFunc, std::string & failTempVar) const;
   bool isTCodeTemporal   (const std::string & tcodeArg) const;
   bool isTCodeIdentifier (const std::string & tcodeArg) const;
+  bool isPromotedParam   (const std::string & tcodeArg) const;
 
   void computeReadWriteHaltInfo();
   std::string              getFuncReturnLLVMType  (const std::string & tcodeFuncIdent)        const;
@@ -123,6 +129,7 @@ class LLVMCodeGen {
 				  std::string::size_type & llvmStringSize);
   void generateReadWriteHaltBeginEndCode(std::string & begin, std::string & end) ;
   void startNewFunction(const subroutine & subr);
+  void computePromotedParams(const subroutine & subr);
   void bindTCodeLocalSymbolsToLLVMTypes(const subroutine & subr);
   std::string dumpSubroutine(const subroutine & subr);
   std::string dumpHeader(const subroutine & subr);
@@ -172,6 +179,8 @@ class LLVMCodeGen {
   std::string createGETELEMENTPTR(const std::string & llvmArrayPointerValue,
                                   const std::string & llvmArrayBaseValue,
                                   const std::string & llvmArrayIndexValue) const;
+  std::string createMEMCPY(const std::string & llvmValue1,
+                           const std::string & llvmValue2, long nElems);
 
   void accessValueOfArgument(const std::string & tcodeArgIn,
                              std::string & llvmArgOut, std::string & llvmAccInstr);
@@ -207,6 +216,11 @@ class LLVMCodeGen {
   std::string llvmComment(const std::string & comm) const;
 
 public:
-  LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode);
+  // With 'promoteRegisters' the scalar parameters a function never
+  // writes keep no alloca: their reads use the incoming argument
+  // register directly (temporals are already emitted as registers,
+  // which is what check_SSA_tCode guarantees)
+  LLVMCodeGen(const TypesMgr & Types, const SymTable & Symbols, const code & tCode,
+              bool promoteRegisters = false);
   std::string dumpLLVM();
 };
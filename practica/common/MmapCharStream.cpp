@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////
+//
+//    MmapCharStream - lexer input over a memory-mapped file
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "MmapCharStream.h"
+
+#include <string>
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+// using namespace std;
+
+
+/// constructor: map the given file read-only
+MmapCharStream::MmapCharStream(const std::string &path) :
+  data{nullptr}, len{0}, pos{0}, name{path}, ok{false} {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode)) {
+    close(fd);
+    return;
+  }
+  len = st.st_size;
+  if (len == 0) {           // an empty file needs no mapping
+    close(fd);
+    ok = true;
+    return;
+  }
+  void *map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return;
+  madvise(map, len, MADV_SEQUENTIAL);   // the lexer goes front to back
+  data = static_cast<const char*>(map);
+  ok = true;
+}
+
+/// destructor: unmap
+MmapCharStream::~MmapCharStream() {
+  if (data != nullptr) munmap(const_cast<char*>(data), len);
+}
+
+/// did the mapping succeed?
+bool MmapCharStream::valid() const {
+  return ok;
+}
+
+// CharStream interface: the mapped bytes are the lexer buffer
+//
+std::size_t MmapCharStream::LA(ssize_t i) {
+  if (i == 0) return 0;   // undefined, as in ANTLRInputStream
+  if (i < 0) {
+    if (std::size_t(-i) > pos) return antlr4::IntStream::EOF;
+    return static_cast<unsigned char>(data[pos + i]);
+  }
+  std::size_t at = pos + i - 1;
+  if (at >= len) return antlr4::IntStream::EOF;
+  return static_cast<unsigned char>(data[at]);
+}
+
+void MmapCharStream::consume() {
+  if (pos >= len)
+    throw antlr4::IllegalStateException("cannot consume EOF");
+  ++pos;
+}
+
+std::size_t MmapCharStream::index() {
+  return pos;
+}
+
+std::size_t MmapCharStream::size() {
+  return len;
+}
+
+/// mark/release do nothing: the whole buffer is always available
+ssize_t MmapCharStream::mark() {
+  return -1;
+}
+
+void MmapCharStream::release(ssize_t /*marker*/) {
+}
+
+void MmapCharStream::seek(std::size_t where) {
+  pos = (where < len ? where : len);
+}
+
+std::string MmapCharStream::getText(const antlr4::misc::Interval &interval) {
+  if (interval.a < 0 or interval.b < interval.a) return "";
+  std::size_t start = interval.a;
+  std::size_t stop  = interval.b;
+  if (start >= len) return "";
+  if (stop >= len) stop = len - 1;
+  return std::string(data + start, stop - start + 1);
+}
+
+std::string MmapCharStream::getSourceName() const {
+  if (name.empty()) return antlr4::IntStream::UNKNOWN_SOURCE_NAME;
+  return name;
+}
+
+std::string MmapCharStream::toString() const {
+  return std::string(data, len);
+}
@@ -0,0 +1,85 @@
+/////////////////////////////////////////////////////////////////
+//
+//    MmapCharStream - lexer input over a memory-mapped file
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////////////////////
+// Class MmapCharStream: a CharStream that serves the lexer straight
+// from a memory-mapped source file. ANTLRInputStream slurps the whole
+// file through an istream and transcodes it into a UTF-32 buffer
+// before the lexer sees one character; here the mapped bytes are the
+// buffer, so there is no up-front copy and the page cache is shared
+// between the batch workers compiling from the same tree.
+// Asl sources are plain ASCII (the grammar admits nothing else), so a
+// byte is a code point and no transcoding is needed.
+// If the file cannot be mapped the caller falls back to the stream
+// path (see valid()); stdin always uses the stream path.
+
+class MmapCharStream final : public antlr4::CharStream {
+
+public:
+
+  /// constructor: map the given file read-only
+  MmapCharStream(const std::string &path);
+  /// destructor: unmap
+  ~MmapCharStream() override;
+
+  /// did the mapping succeed?
+  bool valid() const;
+
+  // CharStream interface
+  std::size_t LA(ssize_t i) override;
+  void consume() override;
+  std::size_t index() override;
+  std::size_t size() override;
+  ssize_t mark() override;
+  void release(ssize_t marker) override;
+  void seek(std::size_t where) override;
+  std::string getText(const antlr4::misc::Interval &interval) override;
+  std::string getSourceName() const override;
+  std::string toString() const override;
+
+private:
+
+  /// the mapped bytes (nullptr for an empty file)
+  const char *data;
+  /// number of bytes
+  std::size_t len;
+  /// current position of the lexer in the buffer
+  std::size_t pos;
+  /// file name (for error messages)
+  std::string name;
+  /// whether the constructor managed to map the file
+  bool ok;
+};
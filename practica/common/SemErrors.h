@@ -32,6 +32,7 @@
 
 #include <string>
 #include <vector>
+#include <iostream>
 
 // using namespace std;
 
@@ -44,6 +45,10 @@
 //   - TypeCheckVisitor
 // Semantic errors emitted are kept in a vector and when the
 // typecheck finishes they will be printed (sorted by line/column number)
+// Two options trade completeness for speed on badly broken inputs:
+// an error budget makes the visitors stop once N errors have been
+// recorded, and streaming prints each error the moment it is found
+// instead of buffering and sorting the whole vector.
 
 class SemErrors {
 
@@ -53,11 +58,31 @@ public:
   SemErrors() = default;
 
   // Write the semantic errors ordered by line number
-  void print ();
+  void print (std::ostream & os = std::cout);
 
   // Accessor to get the number of semantic errors
   std::size_t getNumberOfSemanticErrors () const;
 
+  // Error budget: once n errors have been recorded the semantic
+  // visitors stop early (0 = unlimited, the default)
+  void setErrorBudget (std::size_t n);
+  // Accessor to get the error budget (0 = unlimited)
+  std::size_t getErrorBudget () const;
+  // True when a budget is set and already spent; the visitors check
+  // this to abandon the traversal
+  bool budgetExhausted () const;
+
+  // Stream each error to 'os' the moment it is recorded, instead of
+  // buffering it for print(). Streamed errors come out in discovery
+  // order, not sorted by position
+  void setStreaming (std::ostream & os);
+
+  // Move the errors of 'other' into this object. Used by the parallel
+  // typecheck: each worker records into its own SemErrors and the
+  // buffers are merged here when the workers are done (print sorts by
+  // line/column, so the merge order does not matter)
+  void absorb (SemErrors & other);
+
   // Methods that store the error messages
   //   node is the terminal node correspondig to the token IDENT in a declaration
   void declaredIdent                (antlr4::tree::TerminalNode *node);
@@ -115,15 +140,25 @@ private:
     std::size_t getLine() const;
     std::size_t getColumnInLine() const;
     std::string getMessage() const;
-    void print() const;
+    void print(std::ostream & os) const;
   private:
     std::size_t line, coln;
     std::string message;
   };
 
-  // List of semantic errors
+  // List of semantic errors (left empty in streaming mode)
   std::vector<ErrorInfo> ErrorList;
 
+  // Number of errors recorded (also counts the streamed ones)
+  std::size_t numErrors = 0;
+  // Error budget (0 = unlimited)
+  std::size_t budget = 0;
+  // Stream for streaming mode (nullptr = buffer into ErrorList)
+  std::ostream *streamOut = nullptr;
+
+  // Every error message method above lands here
+  void record (const ErrorInfo & error);
+
   // Compare two errors to determine the order (needed in print)
   static bool less(const ErrorInfo & e1, const ErrorInfo & e2);
 
@@ -29,6 +29,7 @@
 
 #include "TypesMgr.h"
 #include "SymTable.h"
+#include "profiler.h"
 
 #include <string>
 #include <iostream>
@@ -90,6 +91,7 @@ bool SymTable::findInCurrentScope(const std::string & ident) const {
 // Returns -1 if te symbol is not found.
 int SymTable::findInStack(const std::string & ident) const {
   assert(not ScopeIdsStack.empty());
+  ++profiler::symtableFinds;
   int d = 0;
   for (int i = ScopeIdsStack.size() - 1; i >= 0; --i) {
     ScopeId sc = ScopeIdsStack[i];
@@ -251,36 +253,39 @@ void SymTable::ScopeInfo::addFunction(const std::string & ident, TypesMgr::TypeI
   IdentsList.push_back(ident);
 }
 
+// Single-lookup accessor: one hash probe shared by the methods below
+const SymTable::ScopeInfo::SymbolInfo *
+SymTable::ScopeInfo::findSymbolInfo(const std::string & ident) const {
+  auto const & it = SymbolsMap.find(ident);
+  if (it == SymbolsMap.end())
+    return nullptr;
+  return &(it->second);
+}
+
 // Accessor to check the existence of a symbol
 bool SymTable::ScopeInfo::findSymbol(const std::string & ident) const {
-  return (SymbolsMap.find(ident) != SymbolsMap.end());
+  return findSymbolInfo(ident) != nullptr;
 }
 
 // Accessors to check the class of the symbol. If not found return false
 bool SymTable::ScopeInfo::isLocalVarClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isLocalVarClass();
+  const SymbolInfo * info = findSymbolInfo(ident);
+  return (info != nullptr and info->isLocalVarClass());
 }
 bool SymTable::ScopeInfo::isParameterClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isParameterClass();
+  const SymbolInfo * info = findSymbolInfo(ident);
+  return (info != nullptr and info->isParameterClass());
 }
 bool SymTable::ScopeInfo::isFunctionClass(const std::string & ident) const {
-  auto const & it = SymbolsMap.find(ident);
-  if (it == SymbolsMap.end())
-    return false;
-  return it->second.isFunctionClass();
+  const SymbolInfo * info = findSymbolInfo(ident);
+  return (info != nullptr and info->isFunctionClass());
 }
 
 // Accessor to get the TypeId of a symbol. The symbol MUST exist.
 TypesMgr::TypeId SymTable::ScopeInfo::getType(const std::string & ident) const {
-  assert(SymbolsMap.find(ident) != SymbolsMap.end());
-  auto const & it = SymbolsMap.find(ident);
-  return it->second.getType();
+  const SymbolInfo * info = findSymbolInfo(ident);
+  assert(info != nullptr);
+  return info->getType();
 }
 
 // Writes the contents of the scope to the standard output.
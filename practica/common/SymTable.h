@@ -29,9 +29,10 @@
 #pragma once
 
 #include "TypesMgr.h"
+#include "arena.h"
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <cstddef>    // std::size_t
@@ -169,10 +170,19 @@ private:
     // For the name of the scope
     std::string name;
     // The information associated to each identifier declared in this scope.
-    std::map<std::string, SymbolInfo> SymbolsMap;
+    // A flat hash table: visitors look identifiers up once per occurrence,
+    // so resolution is a hash-and-probe instead of log-n string compares.
+    // Nodes come from the per-compilation arena when one is attached
+    // (see arena.h), one node per declared symbol.
+    std::unordered_map<std::string, SymbolInfo,
+                       std::hash<std::string>, std::equal_to<std::string>,
+                       arena_alloc<std::pair<const std::string, SymbolInfo>>> SymbolsMap;
     // For remember the order in which the Ids where introduced.
     std::vector<std::string> IdentsList;
 
+    // Single-lookup accessor used by the methods above (nullptr if absent)
+    const SymbolInfo * findSymbolInfo (const std::string & ident) const;
+
 
     //////////////////////////////////////////////////////////////////
     // Class SymbolInfo: is declared inside ScopeInfo and is private,
@@ -31,34 +31,64 @@
 
 #include "TypesMgr.h"
 #include "SymTable.h"
+#include "profiler.h"
 
 #include "antlr4-runtime.h"
 
 #include <string>
 
 
-// Getters:
+// Overlay constructor
+TreeDecoration::TreeDecoration(const TreeDecoration *base) :
+  Base{base} {
+}
+
+// Getters: a miss falls through to the base (if any), and a node
+// decorated nowhere yields a default value, as ParseTreeProperty did
 SymTable::ScopeId TreeDecoration::getScope(antlr4::ParserRuleContext *ctx) {
-  return ScopeDecor.get(ctx);
+  for (const TreeDecoration *d = this; d != nullptr; d = d->Base) {
+    auto it = d->ScopeDecor.find(ctx);
+    if (it != d->ScopeDecor.end()) return it->second;
+  }
+  return SymTable::ScopeId();
 }
 
 TypesMgr::TypeId TreeDecoration::getType(antlr4::ParserRuleContext *ctx) {
-  return TypeDecor.get(ctx);
+  ++profiler::decorationReads;
+  for (const TreeDecoration *d = this; d != nullptr; d = d->Base) {
+    auto it = d->TypeDecor.find(ctx);
+    if (it != d->TypeDecor.end()) return it->second;
+  }
+  return TypesMgr::TypeId();
 }
 
 bool TreeDecoration::getIsLValue(antlr4::ParserRuleContext *ctx) {
-  return IsLValueDecor.get(ctx);
+  for (const TreeDecoration *d = this; d != nullptr; d = d->Base) {
+    auto it = d->IsLValueDecor.find(ctx);
+    if (it != d->IsLValueDecor.end()) return it->second;
+  }
+  return false;
 }
 
 // Setters:
 void TreeDecoration::putScope(antlr4::ParserRuleContext *ctx, SymTable::ScopeId s) {
-  ScopeDecor.put(ctx, s);
+  ScopeDecor[ctx] = s;
 }
 
 void TreeDecoration::putType(antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t) {
-  TypeDecor.put(ctx, t);
+  TypeDecor[ctx] = t;
 }
 
 void TreeDecoration::putIsLValue(antlr4::ParserRuleContext *ctx, bool b) {
-  IsLValueDecor.put(ctx, b);
+  IsLValueDecor[ctx] = b;
+}
+
+// Move the decorations of 'other' into this one
+void TreeDecoration::absorb(TreeDecoration & other) {
+  for (auto & p : other.ScopeDecor)    ScopeDecor[p.first]    = p.second;
+  for (auto & p : other.TypeDecor)     TypeDecor[p.first]     = p.second;
+  for (auto & p : other.IsLValueDecor) IsLValueDecor[p.first] = p.second;
+  other.ScopeDecor.clear();
+  other.TypeDecor.clear();
+  other.IsLValueDecor.clear();
 }
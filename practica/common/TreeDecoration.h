@@ -31,9 +31,11 @@
 
 #include "TypesMgr.h"
 #include "SymTable.h"
+#include "arena.h"
 
 #include "antlr4-runtime.h"
-#include "tree/ParseTreeProperty.h"
+
+#include <unordered_map>
 
 // using namespace std;
 
@@ -42,8 +44,8 @@
 // Class TreeDecoration: the nodes of the parser tree generated
 // by the antlr4 parser, whose base type is
 // antlr4::ParserRuleContext *, can have different attributes.
-// TreeDecoration groups all of them, and uses different
-// ParseTreeProperty to save this information.
+// TreeDecoration groups all of them, and uses a different
+// hash table (keyed by the node pointer) to save this information.
 // Currently three kinds of attributes may be present:
 //   - scope, for nodes like the program, or functions
 //   - type, for expressions or type especification
@@ -60,10 +62,19 @@
 //       * access the scope attribute
 //       * access the type attribute
 
+// A TreeDecoration can also be built as an overlay over another one:
+// reads that miss the overlay fall through to the base, writes stay
+// in the overlay. The parallel typecheck gives each worker an overlay
+// over the shared decorations (filled by the SymbolsVisitor), so the
+// workers never write to a shared map; when they are done, absorb()
+// moves their decorations into the shared one for the CodeGenVisitor.
+
 class TreeDecoration {
 
 public:
   TreeDecoration() = default;
+  // Overlay constructor: reads fall through to 'base', writes do not
+  explicit TreeDecoration(const TreeDecoration *base);
 
   // Getters:
   SymTable::ScopeId getScope    (antlr4::ParserRuleContext *ctx);
@@ -75,9 +86,25 @@ public:
   void putType     (antlr4::ParserRuleContext *ctx, TypesMgr::TypeId t);
   void putIsLValue (antlr4::ParserRuleContext *ctx, bool b);
 
+  // Move the decorations of 'other' (an overlay) into this one
+  void absorb (TreeDecoration & other);
+
 private:
-  antlr4::tree::ParseTreeProperty<SymTable::ScopeId> ScopeDecor;
-  antlr4::tree::ParseTreeProperty<TypesMgr::TypeId>  TypeDecor;
-  antlr4::tree::ParseTreeProperty<bool>              IsLValueDecor;
+  // Base decoration for overlays (nullptr for a plain one)
+  const TreeDecoration *Base = nullptr;
+
+  // the maps take their nodes from the per-compilation arena when
+  // one is attached (see arena.h); one node per decorated tree node
+  // makes these the biggest front-end allocation source
+  template <typename V>
+  using decormap =
+    std::unordered_map<antlr4::ParserRuleContext*, V,
+                       std::hash<antlr4::ParserRuleContext*>,
+                       std::equal_to<antlr4::ParserRuleContext*>,
+                       arena_alloc<std::pair<antlr4::ParserRuleContext* const, V>>>;
+
+  decormap<SymTable::ScopeId> ScopeDecor;
+  decormap<TypesMgr::TypeId>  TypeDecor;
+  decormap<bool>              IsLValueDecor;
 
 };  // class TreeDecoration
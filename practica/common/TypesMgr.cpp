@@ -28,9 +28,11 @@
 
 
 #include "TypesMgr.h"
+#include "profiler.h"
 
 #include <vector>
 #include <string>
+#include <utility>    // std::pair, std::make_pair
 #include <iostream>
 
 #include <cstddef>    // std::size_t
@@ -87,14 +89,28 @@ TypesMgr::TypeId TypesMgr::createVoidTy() {
 
 TypesMgr::TypeId TypesMgr::createFunctionTy(const std::vector<TypeId> & paramsTypes,
 					    TypeId returnType) {
+  auto key = std::make_pair(paramsTypes, returnType);
+  auto it = FunctionTyIds.find(key);
+  if (it != FunctionTyIds.end())
+    return it->second;
   TypesVec.push_back(Type(paramsTypes, returnType));
-  return TypesVec.size()-1;
+  TypeId tid = TypesVec.size()-1;
+  FunctionTyIds[key] = tid;
+  ++profiler::typesCreated;
+  return tid;
 }
 
 TypesMgr::TypeId TypesMgr::createArrayTy(unsigned int size,
 					 TypeId elemType) {
+  auto key = std::make_pair(size, elemType);
+  auto it = ArrayTyIds.find(key);
+  if (it != ArrayTyIds.end())
+    return it->second;
   TypesVec.push_back(Type{size, elemType});
-  return TypesVec.size()-1;
+  TypeId tid = TypesVec.size()-1;
+  ArrayTyIds[key] = tid;
+  ++profiler::typesCreated;
+  return tid;
 }
 
 // ----------------------------------------------------------------------
@@ -206,6 +222,9 @@ TypesMgr::TypeId TypesMgr::getArrayElemType(TypeId tid) const {
 // methods for checking different compatibilities of Types
 
 bool TypesMgr::equalTypes(TypeId tid1, TypeId tid2) const {
+  // since compound types are hash-consed at creation, structurally
+  // equal types share one TypeId and this check decides almost always;
+  // the structural recursion below is kept as a safety net
   if (tid1 == tid2)
     return true;
   const Type & t1 = TypesVec.at(tid1);
@@ -29,9 +29,12 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <string>
 #include <iostream>
 
+#include "arena.h"
+
 #include <cstddef>    // std::size_t
 
 // using namespace std;
@@ -124,6 +127,20 @@ private:
   // Attributes:
   //   - vector to save the Types
   std::vector<Type> TypesVec;
+  //   - indexes to find an already created compound type again, so
+  //     structurally equal types always share one TypeId (hash-consing).
+  //     With this, equalTypes on two ids created by this manager never
+  //     needs to recurse: equal structure implies equal TypeId.
+  //     Their nodes come from the per-compilation arena when one is
+  //     attached (see arena.h)
+  std::map<std::pair<unsigned int, TypeId>, TypeId,
+           std::less<std::pair<unsigned int, TypeId>>,
+           arena_alloc<std::pair<const std::pair<unsigned int, TypeId>, TypeId>>>
+    ArrayTyIds;
+  std::map<std::pair<std::vector<TypeId>, TypeId>, TypeId,
+           std::less<std::pair<std::vector<TypeId>, TypeId>>,
+           arena_alloc<std::pair<const std::pair<std::vector<TypeId>, TypeId>, TypeId>>>
+    FunctionTyIds;
 
   // There are eight kinds of types:
   //   - an especial kind error,
@@ -0,0 +1,95 @@
+/////////////////////////////////////////////////////////////////
+//
+//    arena - per-compilation bump allocator
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "arena.h"
+
+#include <cstdlib>    // std::malloc, std::free
+
+// using namespace std;
+
+
+thread_local arena *arena::attached = nullptr;
+
+const std::size_t arena::CHUNK_BYTES;
+
+
+arena::arena() {
+}
+
+arena::~arena() {
+  reset();
+}
+
+/// start a new chunk with at least 'atleast' payload bytes
+void arena::grow(std::size_t atleast) {
+  std::size_t payload = (atleast > CHUNK_BYTES ? atleast : CHUNK_BYTES);
+  chunk *c = static_cast<chunk*>(std::malloc(sizeof(chunk) + payload));
+  c->next = head;
+  c->used = 0;
+  c->size = payload;
+  head = c;
+}
+
+/// take 'bytes' bytes from the current chunk (a pointer bump)
+void *arena::alloc(std::size_t bytes, std::size_t align) {
+  if (head != nullptr) {
+    std::size_t at = (head->used + align - 1) & ~(align - 1);
+    if (at + bytes <= head->size) {
+      head->used = at + bytes;
+      return reinterpret_cast<char*>(head + 1) + at;
+    }
+  }
+  // the payload starts right after the header, which malloc aligns
+  // for any type, so a fresh chunk needs no alignment fix-up
+  grow(bytes + align);
+  head->used = bytes;
+  return reinterpret_cast<char*>(head + 1);
+}
+
+/// return every chunk in one shot
+void arena::reset() {
+  while (head != nullptr) {
+    chunk *c = head;
+    head = c->next;
+    std::free(c);
+  }
+}
+
+/// the arena attached to the current thread (nullptr = none)
+arena *arena::current() {
+  return attached;
+}
+
+arena::scope::scope(arena &a) :
+  saved{attached} {
+  attached = &a;
+}
+
+arena::scope::~scope() {
+  attached = saved;
+}
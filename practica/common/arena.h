@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////
+//
+//    arena - per-compilation bump allocator
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>    // std::size_t
+
+
+////////////////////////////////////////////////////////////////////
+/// Class arena is a bump allocator for state that lives exactly as
+/// long as one compilation: allocations are a pointer increment in a
+/// chunk, nothing is freed individually, and the whole arena is
+/// returned in one shot when the compilation ends. The front-end
+/// containers (TreeDecoration, TypesMgr, SymTable) take their node
+/// memory from the arena attached to the current thread, or from the
+/// regular heap when none is attached, so every other use of those
+/// classes is unaffected.
+///
+/// The attached arena is thread-local: each batch worker (and each
+/// compile-server request) gets its own, which makes the per-request
+/// cleanup a handful of chunk frees instead of millions of node
+/// frees. An arena must outlive every object allocated from it;
+/// declare it first in the scope that attaches it.
+
+class arena {
+public:
+  arena();
+  ~arena();
+  arena(const arena &) = delete;
+  arena & operator=(const arena &) = delete;
+
+  /// take 'bytes' bytes from the current chunk (a pointer bump)
+  void *alloc(std::size_t bytes, std::size_t align);
+  /// return every chunk in one shot
+  void reset();
+
+  /// the arena attached to the current thread (nullptr = none)
+  static arena *current();
+
+  /// attach an arena to the current thread for one scope
+  class scope {
+  public:
+    explicit scope(arena &a);
+    ~scope();
+    scope(const scope &) = delete;
+    scope & operator=(const scope &) = delete;
+  private:
+    arena *saved;
+  };
+
+private:
+  /// chunk header; the payload follows it in the same allocation
+  struct chunk {
+    chunk       *next;
+    std::size_t  used;
+    std::size_t  size;
+  };
+  /// default chunk payload size (big allocations get their own chunk)
+  static const std::size_t CHUNK_BYTES = 1 << 20;
+
+  /// most recent chunk (the only one allocated from)
+  chunk *head = nullptr;
+
+  /// arena attached to this thread
+  static thread_local arena *attached;
+
+  /// start a new chunk with at least 'atleast' payload bytes
+  void grow(std::size_t atleast);
+};
+
+
+////////////////////////////////////////////////////////////////////
+/// arena_alloc: a standard allocator that takes its memory from the
+/// arena attached when the container was created, or from the heap
+/// when none was. Deallocation of arena memory is a no-op (the arena
+/// frees wholesale), so container destructors stop paying one free
+/// per node.
+
+template <typename T>
+class arena_alloc {
+public:
+  typedef T value_type;
+
+  arena_alloc() : a{arena::current()} {}
+  template <typename U>
+  arena_alloc(const arena_alloc<U> &other) : a{other.a} {}
+
+  T *allocate(std::size_t n) {
+    if (a != nullptr)
+      return static_cast<T*>(a->alloc(n * sizeof(T), alignof(T)));
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  void deallocate(T *p, std::size_t) {
+    if (a == nullptr) ::operator delete(p);
+  }
+
+  /// the arena backing this allocator (nullptr = heap)
+  arena *a;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_alloc<T> &x, const arena_alloc<U> &y) {
+  return x.a == y.a;
+}
+template <typename T, typename U>
+bool operator!=(const arena_alloc<T> &x, const arena_alloc<U> &y) {
+  return x.a != y.a;
+}
@@ -0,0 +1,176 @@
+/////////////////////////////////////////////////////////////////
+//
+//    aslrt - buffered I/O runtime for compiled Asl programs
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+// The read/write statements of a program emitted with
+// '--emit-llvm --bufferedIO' call the asl_* functions below instead
+// of scanf/printf/putchar, so a value costs an append to a buffer
+// rather than a stdio round trip; the buffers move in 64KB blocks.
+// Link this file together with the emitted module:
+//
+//    clang program.ll aslrt.cpp
+//
+// Only the C library is used (no iostreams, no allocation), so the
+// plain clang driver links it. Output is pushed out before every
+// read and, through atexit, when the program ends.
+
+#include <cstdio>     // snprintf
+#include <cstdlib>    // atexit, strtof
+#include <cstring>    // memcpy
+
+#include <unistd.h>   // read, write
+
+static char   obuf[1 << 16];
+static size_t opos = 0;
+static char   ibuf[1 << 16];
+static size_t ipos = 0, ilen = 0;
+static int    flushRegistered = 0;
+
+extern "C" void asl_flush(void) {
+  size_t done = 0;
+  while (done < opos) {
+    ssize_t n = write(1, obuf + done, opos - done);
+    if (n <= 0) break;
+    done += n;
+  }
+  opos = 0;
+}
+
+static void putbyte(char c) {
+  if (not flushRegistered) {
+    atexit(asl_flush);
+    flushRegistered = 1;
+  }
+  if (opos == sizeof(obuf)) asl_flush();
+  obuf[opos++] = c;
+}
+
+static void puttext(const char *s, size_t n) {
+  while (n > 0) {
+    if (opos == sizeof(obuf)) asl_flush();
+    size_t room = sizeof(obuf) - opos;
+    size_t take = n < room ? n : room;
+    memcpy(obuf + opos, s, take);
+    opos += take;
+    s += take;
+    n -= take;
+  }
+  if (not flushRegistered) {
+    atexit(asl_flush);
+    flushRegistered = 1;
+  }
+}
+
+static int peekbyte(void) {
+  if (ipos >= ilen) {
+    ssize_t n = read(0, ibuf, sizeof(ibuf));
+    if (n <= 0) return -1;
+    ilen = n;
+    ipos = 0;
+  }
+  return (unsigned char)ibuf[ipos];
+}
+
+static void skipws(void) {
+  int c = peekbyte();
+  while (c == ' ' or c == '\t' or c == '\n' or c == '\r' or
+         c == '\f' or c == '\v') {
+    ++ipos;
+    c = peekbyte();
+  }
+}
+
+extern "C" void asl_writei(int v) {
+  char digits[12];
+  size_t n = 0;
+  long l = v;
+  if (l < 0) { putbyte('-'); l = -l; }
+  do {
+    digits[n++] = (char)('0' + l % 10);
+    l /= 10;
+  } while (l > 0);
+  while (n > 0) putbyte(digits[--n]);
+}
+
+extern "C" void asl_writef(float v) {
+  char text[32];
+  int n = snprintf(text, sizeof(text), "%g", (double)v);
+  puttext(text, n);
+}
+
+extern "C" void asl_writec(int c) {
+  putbyte((char)c);
+}
+
+extern "C" void asl_writes(const char *s) {
+  puttext(s, strlen(s));
+}
+
+extern "C" int asl_readi(void) {
+  asl_flush();
+  skipws();
+  int negative = 0;
+  int c = peekbyte();
+  if (c == '-' or c == '+') {
+    negative = (c == '-');
+    ++ipos;
+    c = peekbyte();
+  }
+  long l = 0;
+  while (c >= '0' and c <= '9') {
+    l = l * 10 + (c - '0');
+    ++ipos;
+    c = peekbyte();
+  }
+  return (int)(negative ? -l : l);
+}
+
+extern "C" float asl_readf(void) {
+  asl_flush();
+  skipws();
+  char text[64];
+  size_t n = 0;
+  int c = peekbyte();
+  while (n + 1 < sizeof(text) and
+         ((c >= '0' and c <= '9') or c == '-' or c == '+' or
+          c == '.' or c == 'e' or c == 'E')) {
+    text[n++] = (char)c;
+    ++ipos;
+    c = peekbyte();
+  }
+  text[n] = '\0';
+  return strtof(text, NULL);
+}
+
+extern "C" int asl_readc(void) {
+  asl_flush();
+  skipws();
+  int c = peekbyte();
+  if (c < 0) return 0;
+  ++ipos;
+  return c;
+}
@@ -0,0 +1,227 @@
+/////////////////////////////////////////////////////////////////
+//
+//    bincode - binary serialization of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdlib>    // EXIT_FAILURE
+#include <cstring>    // std::memcpy
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+#include "bincode.h"
+
+using namespace std;
+
+const char bincode::MAGIC[4] = {'T', 'B', 'C', '1'};
+
+
+////////////////////////////////////////////////////////////////////
+/// writing
+
+namespace {
+
+  /// the string table being built while writing: each distinct text
+  /// is stored once and referenced by its index
+  class strtable {
+  public:
+    uint32_t intern(const string &s) {
+      auto p = index.find(s);
+      if (p != index.end()) return p->second;
+      uint32_t i = texts.size();
+      texts.push_back(s);
+      index.insert(make_pair(s, i));
+      return i;
+    }
+    const vector<string> & get_texts() const { return texts; }
+  private:
+    vector<string> texts;
+    unordered_map<string, uint32_t> index;
+  };
+
+  void put32(ostream &os, uint32_t x) {
+    os.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+}
+
+/// write the program in binary form to the given file
+void bincode::write(const code &c, const string &path) {
+  // pass 1: intern every text, so the string table can go first and
+  // the loader can resolve indices as it walks the records
+  strtable tab;
+  struct subrec { uint32_t name; vector<uint32_t> words; };
+  vector<subrec> recs;
+  for (const subroutine &s : c.get_subroutine_list()) {
+    subrec r;
+    r.name = tab.intern(s.get_name());
+    r.words.push_back(s.params.size());
+    for (const var &p : s.params) {
+      r.words.push_back(tab.intern(p.name));
+      r.words.push_back(tab.intern(p.type));
+      r.words.push_back(p.nelem);
+    }
+    r.words.push_back(s.vars.size());
+    for (const var &v : s.vars) {
+      r.words.push_back(tab.intern(v.name));
+      r.words.push_back(tab.intern(v.type));
+      r.words.push_back(v.nelem);
+    }
+    const instructionList &ins = s.get_instructions();
+    r.words.push_back(ins.size());
+    for (const instruction &i : ins) {
+      r.words.push_back(i.oper);
+      r.words.push_back(tab.intern(i.arg1.str()));
+      r.words.push_back(tab.intern(i.arg2.str()));
+      r.words.push_back(tab.intern(i.arg3.str()));
+    }
+    recs.push_back(std::move(r));
+  }
+
+  ofstream os(path, ofstream::binary);
+  if (not os) {
+    cerr << "bincode: cannot write " << path << endl;
+    exit(EXIT_FAILURE);
+  }
+  os.write(MAGIC, sizeof(MAGIC));
+  put32(os, tab.get_texts().size());
+  for (const string &t : tab.get_texts()) {
+    put32(os, t.size());
+    os.write(t.data(), t.size());
+  }
+  put32(os, recs.size());
+  for (const subrec &r : recs) {
+    put32(os, r.name);
+    for (uint32_t w : r.words) put32(os, w);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////
+/// loading
+
+uint32_t bincode::get32(const unsigned char *p) {
+  uint32_t x;
+  memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+void bincode::malformed(const string &path) {
+  cerr << "bincode: " << path << " is not a valid binary t-code file" << endl;
+  exit(EXIT_FAILURE);
+}
+
+/// load a program from a binary file (memory-mapped, not parsed)
+code bincode::load(const string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    cerr << "bincode: cannot read " << path << endl;
+    exit(EXIT_FAILURE);
+  }
+  struct stat st;
+  fstat(fd, &st);
+  size_t size = st.st_size;
+  void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    cerr << "bincode: cannot map " << path << endl;
+    exit(EXIT_FAILURE);
+  }
+  const unsigned char *p   = static_cast<const unsigned char*>(map);
+  const unsigned char *end = p + size;
+
+  // every read below checks it stays inside the mapping
+  auto need = [&](size_t n) { if (size_t(end - p) < n) malformed(path); };
+
+  need(sizeof(MAGIC) + 4);
+  if (memcmp(p, MAGIC, sizeof(MAGIC)) != 0) malformed(path);
+  p += sizeof(MAGIC);
+
+  // string table
+  uint32_t numtexts = get32(p); p += 4;
+  vector<string> texts(numtexts);
+  for (uint32_t i = 0; i < numtexts; ++i) {
+    need(4);
+    uint32_t len = get32(p); p += 4;
+    need(len);
+    texts[i] = string(reinterpret_cast<const char*>(p), len);
+    p += len;
+  }
+  auto text = [&](uint32_t i) -> const string & {
+    if (i >= numtexts) malformed(path);
+    return texts[i];
+  };
+
+  // subroutines: params and vars go straight into the lists, and the
+  // instructions through add_instruction, which rebuilds the label
+  // map and the resolved branch targets
+  code c;
+  need(4);
+  uint32_t numsubs = get32(p); p += 4;
+  for (uint32_t k = 0; k < numsubs; ++k) {
+    need(8);
+    subroutine s(text(get32(p))); p += 4;
+    uint32_t numparams = get32(p); p += 4;
+    for (uint32_t i = 0; i < numparams; ++i) {
+      need(12);
+      const string &nm = text(get32(p));
+      const string &ty = text(get32(p+4));
+      s.params.push_back(var(nm, ty, get32(p+8)));
+      p += 12;
+    }
+    need(4);
+    uint32_t numvars = get32(p); p += 4;
+    for (uint32_t i = 0; i < numvars; ++i) {
+      need(12);
+      const string &nm = text(get32(p));
+      const string &ty = text(get32(p+4));
+      s.add_var(nm, ty, get32(p+8));
+      p += 12;
+    }
+    need(4);
+    uint32_t numinstrs = get32(p); p += 4;
+    for (uint32_t i = 0; i < numinstrs; ++i) {
+      need(16);
+      uint32_t op = get32(p);
+      if (op >= instruction::_INVALID) malformed(path);
+      s.add_instruction(instruction(instruction::Operation(op),
+                                    text(get32(p+4)), text(get32(p+8)),
+                                    text(get32(p+12))));
+      p += 16;
+    }
+    c.add_subroutine(s);
+  }
+
+  munmap(map, size);
+  return c;
+}
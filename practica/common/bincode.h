@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////
+//
+//    bincode - binary serialization of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class bincode reads and writes the binary form of a compiled
+/// program, as an alternative to the text of code::dump() that has
+/// to be lexed and parsed again on every execution.
+///
+/// The format is a string table (each distinct operand, name or type
+/// text stored once) followed by fixed-width records: every
+/// instruction is four 32-bit words (opcode and three string table
+/// indices), every parameter and variable three. A program is loaded
+/// by memory-mapping the file and walking those records, with no
+/// parsing; labels and branch targets are rebuilt by
+/// subroutine::add_instruction as the instructions are re-added.
+/// Integers are stored in the byte order of the machine that wrote
+/// the file (compilers and the execution fleet share one
+/// architecture).
+
+class bincode {
+public:
+  /// write the program in binary form to the given file
+  static void write(const code &c, const std::string &path);
+  /// load a program from a binary file (memory-mapped, not parsed)
+  static code load(const std::string &path);
+
+private:
+  /// first bytes of every binary program file
+  static const char MAGIC[4];
+
+  /// read one 32-bit word at p (records are not aligned, since the
+  /// string table has arbitrary byte lengths)
+  static std::uint32_t get32(const unsigned char *p);
+  /// complain about a truncated or foreign file, and give up
+  static void malformed(const std::string &path);
+};
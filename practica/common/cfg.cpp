@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////
+//
+//    cfg - basic-block view of a subroutine's t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include "cfg.h"
+
+using namespace std;
+
+const size_t cfg::no_block;
+
+
+/// build the flow graph of a subroutine
+cfg::cfg(const subroutine &s) {
+  const instructionList & l = s.get_instructions();
+  size_t n = l.size();
+  if (n == 0) return;
+
+  // leaders: the first instruction, every label, and whatever
+  // follows a jump or an exit
+  vector<bool> leader(n, false);
+  leader[0] = true;
+  for (size_t k = 0; k < n; ++k) {
+    switch (l[k].oper) {
+    case instruction::_LABEL:
+      leader[k] = true;
+      break;
+    case instruction::_UJUMP:
+    case instruction::_FJUMP:
+    case instruction::_RETURN:
+    case instruction::_HALT:
+      if (k + 1 < n) leader[k+1] = true;
+      break;
+    default:
+      break;
+    }
+  }
+
+  // blocks run from one leader up to the next
+  blockof.assign(n, 0);
+  for (size_t k = 0; k < n; ++k) {
+    if (leader[k]) {
+      block b;
+      b.first = k;
+      b.last  = k + 1;
+      blocks.push_back(b);
+    }
+    blockof[k] = blocks.size() - 1;
+    blocks.back().last = k + 1;
+  }
+
+  // successors, from the last instruction of each block
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    size_t k = blocks[b].last - 1;
+    size_t target = s.get_branch_target(k);
+    switch (l[k].oper) {
+    case instruction::_UJUMP:
+      if (target < n) blocks[b].succs.push_back(blockof[target]);
+      break;
+    case instruction::_FJUMP:
+      if (target < n) blocks[b].succs.push_back(blockof[target]);
+      if (b + 1 < blocks.size() and
+          (target >= n or blockof[target] != b + 1))
+        blocks[b].succs.push_back(b + 1);
+      break;
+    case instruction::_RETURN:
+    case instruction::_HALT:
+      break;
+    default:
+      if (b + 1 < blocks.size()) blocks[b].succs.push_back(b + 1);
+      break;
+    }
+    for (size_t t : blocks[b].succs) blocks[t].preds.push_back(b);
+  }
+
+  compute_reachable();
+}
+
+/// the blocks, in instruction order (block 0 is the entry)
+const vector<cfg::block> & cfg::get_blocks() const {
+  return blocks;
+}
+
+/// the block containing the instruction at pc
+size_t cfg::block_of(size_t pc) const {
+  if (pc >= blockof.size()) return no_block;
+  return blockof[pc];
+}
+
+/// for each block, can it be reached from the entry block?
+const vector<bool> & cfg::reachable() const {
+  return reach;
+}
+
+/// fill 'reach' (depth-first from the entry block)
+void cfg::compute_reachable() {
+  reach.assign(blocks.size(), false);
+  vector<size_t> pending;
+  pending.push_back(0);
+  reach[0] = true;
+  while (not pending.empty()) {
+    size_t b = pending.back();
+    pending.pop_back();
+    for (size_t t : blocks[b].succs)
+      if (not reach[t]) {
+        reach[t] = true;
+        pending.push_back(t);
+      }
+  }
+}
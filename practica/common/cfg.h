@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////////////////////
+//
+//    cfg - basic-block view of a subroutine's t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class cfg is a basic-block view of one subroutine's instruction
+/// list, so control-flow-aware passes stop reinventing label
+/// scanning. The instructions themselves stay where they are: a
+/// block is an index range over the subroutine's vector, and the
+/// successor/predecessor lists hold block indexes. Boundaries come
+/// from _LABEL (a leader) and _UJUMP/_FJUMP/_RETURN/_HALT (their
+/// follower is a leader); branch targets are the ones the subroutine
+/// resolved when the instructions were added.
+/// The view is a snapshot: rebuild it after rewriting the
+/// instruction list.
+
+class cfg {
+public:
+  /// one basic block: the range [first, last) over the subroutine's
+  /// instruction list, plus its successor and predecessor blocks
+  struct block {
+    size_t first;
+    size_t last;
+    std::vector<size_t> succs;
+    std::vector<size_t> preds;
+  };
+
+  /// value returned by block_of for an out-of-range pc
+  static const size_t no_block = size_t(-1);
+
+  /// build the flow graph of a subroutine
+  explicit cfg(const subroutine &s);
+
+  /// the blocks, in instruction order (block 0 is the entry)
+  const std::vector<block> & get_blocks() const;
+  /// the block containing the instruction at pc
+  size_t block_of(size_t pc) const;
+  /// for each block, can it be reached from the entry block?
+  const std::vector<bool> & reachable() const;
+
+private:
+  /// the blocks, in instruction order
+  std::vector<block> blocks;
+  /// pc -> block index
+  std::vector<size_t> blockof;
+  /// reachability of each block from the entry
+  std::vector<bool> reach;
+
+  /// fill 'reach' (depth-first from the entry block)
+  void compute_reachable();
+};
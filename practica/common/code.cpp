@@ -27,12 +27,51 @@
 ////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <sstream>    // std::ostringstream
+#include <iterator>   // std::make_move_iterator
+#include <utility>    // std::move
 #include <vector>
 #include "code.h"
 #include "LLVMCodeGen.h"
+#include "profiler.h"
 
 using namespace std;
 
+////////////////////////////////////////////////////////////////////
+/// Implementation for class 'operand'
+
+/// shared table of distinct operand texts (entry 0 is ""), one per thread
+thread_local std::vector<std::string> operand::table(1);
+thread_local std::unordered_map<std::string, std::uint32_t> operand::tableIndex;
+
+/// intern s and return its index in the table
+std::uint32_t operand::intern(const std::string &s) {
+  if (s.empty()) return 0;
+  auto it = tableIndex.find(s);
+  if (it != tableIndex.end()) return it->second;
+  std::uint32_t i = table.size();
+  table.push_back(s);
+  tableIndex.insert(make_pair(s, i));
+  return i;
+}
+
+/// constructors
+operand::operand() : idx(0) {}
+operand::operand(const std::string &s) : idx(intern(s)) {}
+operand::operand(const char *s) : idx(intern(s)) {}
+
+/// get the interned text back
+const std::string & operand::str() const { return table[idx]; }
+operand::operator const std::string & () const { return table[idx]; }
+/// true if the operand holds the empty text
+bool operand::empty() const { return idx == 0; }
+/// index of the interned text in the shared table
+std::uint32_t operand::id() const { return idx; }
+
+bool operand::operator==(const operand &o) const { return idx == o.idx; }
+bool operand::operator!=(const operand &o) const { return idx != o.idx; }
+
+
 ////////////////////////////////////////////////////////////////////
 /// Implementation for class 'instruction'
 
@@ -79,6 +118,7 @@ instruction instruction::CHLOAD(const std::string &a1, const std::string &a2) {
 instruction instruction::FLOAD(const std::string &a1, const std::string &a2) { return instruction(_FLOAD, a1, a2); }
 instruction instruction::XLOAD(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_XLOAD, a1, a2, a3); }
 instruction instruction::LOADX(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_LOADX, a1, a2, a3); }
+instruction instruction::ACOPY(const std::string &a1, const std::string &a2, const std::string &a3) { return instruction(_ACOPY, a1, a2, a3); }
 instruction instruction::ALOAD(const std::string &a1, const std::string &a2) { return instruction(_ALOAD, a1, a2); }
 instruction instruction::LOADC(const std::string &a1, const std::string &a2) { return instruction(_LOADC, a1, a2); }
 instruction instruction::CLOAD(const std::string &a1, const std::string &a2) { return instruction(_CLOAD, a1, a2); }
@@ -100,51 +140,52 @@ string instruction::dump() const {
   string s;
   string ind="   ";
   switch (oper) {
-  case instruction::_LABEL : { s = "label " + arg1 + " :"; ind = ""; break; }
-  case instruction::_UJUMP : { s = "goto " + arg1; break; }
-  case instruction::_FJUMP : { s = "ifFalse " + arg1 + " goto " +arg2; break; }
-  case instruction::_HALT  : { s = "halt \"" + arg1 + "\""; break; }
+  case instruction::_LABEL : { s = "label " + arg1.str() + " :"; ind = ""; break; }
+  case instruction::_UJUMP : { s = "goto " + arg1.str(); break; }
+  case instruction::_FJUMP : { s = "ifFalse " + arg1.str() + " goto " +arg2.str(); break; }
+  case instruction::_HALT  : { s = "halt \"" + arg1.str() + "\""; break; }
   case instruction::_LOAD  : 
   case instruction::_FLOAD : 
-  case instruction::_ILOAD : { s = arg1 + " = " + arg2; break; } 
-  case instruction::_CHLOAD : { s = arg1 + " = '" + arg2 +"'"; break; } 
-  case instruction::_PUSH : { s = "pushparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_POP : { s = "popparam " + (arg1.empty()? "" : arg1); break; }
-  case instruction::_CALL : { s = "call " + arg1; break; }
+  case instruction::_ILOAD : { s = arg1.str() + " = " + arg2.str(); break; } 
+  case instruction::_CHLOAD : { s = arg1.str() + " = '" + arg2.str() +"'"; break; } 
+  case instruction::_PUSH : { s = "pushparam " + (arg1.str().empty()? "" : arg1.str()); break; }
+  case instruction::_POP : { s = "popparam " + (arg1.str().empty()? "" : arg1.str()); break; }
+  case instruction::_CALL : { s = "call " + arg1.str(); break; }
   case instruction::_RETURN : { s = "return"; break; }
-  case instruction::_XLOAD : { s = arg1 + "[" + arg2 + "] = " + arg3; break; }
-  case instruction::_LOADX : { s = arg1 + " = " + arg2 + "[" + arg3 + "]"; break; }
-  case instruction::_ALOAD : { s = arg1 + " = &" + arg2; break; }
-  case instruction::_LOADC : { s = arg1 + " = *" + arg2; break; }
-  case instruction::_CLOAD : { s = "*" + arg1 + " = " + arg2; break; }
-  case instruction::_READI : { s = "readi " + arg1; break; }
-  case instruction::_READF : { s = "readf " + arg1; break; }
-  case instruction::_READC : { s = "readc " + arg1; break; }
-  case instruction::_WRITEI : { s = "writei " + arg1; break; }
-  case instruction::_WRITEF : { s = "writef " + arg1; break; }
-  case instruction::_WRITEC : { s = "writec " + arg1; break; }
-  case instruction::_WRITES : { s = "writes " + arg1; break; }
+  case instruction::_XLOAD : { s = arg1.str() + "[" + arg2.str() + "] = " + arg3.str(); break; }
+  case instruction::_LOADX : { s = arg1.str() + " = " + arg2.str() + "[" + arg3.str() + "]"; break; }
+  case instruction::_ACOPY : { s = "acopy " + arg1.str() + " " + arg2.str() + " " + arg3.str(); break; }
+  case instruction::_ALOAD : { s = arg1.str() + " = &" + arg2.str(); break; }
+  case instruction::_LOADC : { s = arg1.str() + " = *" + arg2.str(); break; }
+  case instruction::_CLOAD : { s = "*" + arg1.str() + " = " + arg2.str(); break; }
+  case instruction::_READI : { s = "readi " + arg1.str(); break; }
+  case instruction::_READF : { s = "readf " + arg1.str(); break; }
+  case instruction::_READC : { s = "readc " + arg1.str(); break; }
+  case instruction::_WRITEI : { s = "writei " + arg1.str(); break; }
+  case instruction::_WRITEF : { s = "writef " + arg1.str(); break; }
+  case instruction::_WRITEC : { s = "writec " + arg1.str(); break; }
+  case instruction::_WRITES : { s = "writes " + arg1.str(); break; }
   case instruction::_WRITELN : { s = "writeln"; break; }
-  case instruction::_ADD : { s = arg1 + " = " + arg2 + " + " + arg3; break; }
-  case instruction::_SUB : { s = arg1 + " = " + arg2 + " - " + arg3; break; }
-  case instruction::_MUL : { s = arg1 + " = " + arg2 + " * " + arg3; break; }
-  case instruction::_DIV : { s = arg1 + " = " + arg2 + " / " + arg3; break; }
-  case instruction::_AND : { s = arg1 + " = " + arg2 + " and " + arg3; break; }
-  case instruction::_OR : { s = arg1 + " = " + arg2 + " or " + arg3; break; }
-  case instruction::_EQ : { s = arg1 + " = " + arg2 + " == " + arg3; break; }
-  case instruction::_LT : { s = arg1 + " = " + arg2 + " < " + arg3; break; }
-  case instruction::_LE : { s = arg1 + " = " + arg2 + " <= " + arg3; break; }
-  case instruction::_NOT : { s = arg1 + " = not " + arg2; break; }
-  case instruction::_NEG : { s = arg1 + " = - " + arg2; break; }
-  case instruction::_FADD : { s = arg1 + " = " + arg2 + " +. " + arg3; break; }
-  case instruction::_FSUB : { s = arg1 + " = " + arg2 + " -. " + arg3; break; }
-  case instruction::_FMUL : { s = arg1 + " = " + arg2 + " *. " + arg3; break; }
-  case instruction::_FDIV : { s = arg1 + " = " + arg2 + " /. " + arg3; break; }
-  case instruction::_FEQ : { s = arg1 + " = " + arg2 + " ==. " + arg3; break; }
-  case instruction::_FLT : { s = arg1 + " = " + arg2 + " <. " + arg3; break; }
-  case instruction::_FLE : { s =  arg1 + " = " + arg2 + " <=. " + arg3; break; }
-  case instruction::_FNEG : { s =  arg1 + " = -. " + arg2; break; }
-  case instruction::_FLOAT : { s = arg1 + " = float " + arg2; break; }
+  case instruction::_ADD : { s = arg1.str() + " = " + arg2.str() + " + " + arg3.str(); break; }
+  case instruction::_SUB : { s = arg1.str() + " = " + arg2.str() + " - " + arg3.str(); break; }
+  case instruction::_MUL : { s = arg1.str() + " = " + arg2.str() + " * " + arg3.str(); break; }
+  case instruction::_DIV : { s = arg1.str() + " = " + arg2.str() + " / " + arg3.str(); break; }
+  case instruction::_AND : { s = arg1.str() + " = " + arg2.str() + " and " + arg3.str(); break; }
+  case instruction::_OR : { s = arg1.str() + " = " + arg2.str() + " or " + arg3.str(); break; }
+  case instruction::_EQ : { s = arg1.str() + " = " + arg2.str() + " == " + arg3.str(); break; }
+  case instruction::_LT : { s = arg1.str() + " = " + arg2.str() + " < " + arg3.str(); break; }
+  case instruction::_LE : { s = arg1.str() + " = " + arg2.str() + " <= " + arg3.str(); break; }
+  case instruction::_NOT : { s = arg1.str() + " = not " + arg2.str(); break; }
+  case instruction::_NEG : { s = arg1.str() + " = - " + arg2.str(); break; }
+  case instruction::_FADD : { s = arg1.str() + " = " + arg2.str() + " +. " + arg3.str(); break; }
+  case instruction::_FSUB : { s = arg1.str() + " = " + arg2.str() + " -. " + arg3.str(); break; }
+  case instruction::_FMUL : { s = arg1.str() + " = " + arg2.str() + " *. " + arg3.str(); break; }
+  case instruction::_FDIV : { s = arg1.str() + " = " + arg2.str() + " /. " + arg3.str(); break; }
+  case instruction::_FEQ : { s = arg1.str() + " = " + arg2.str() + " ==. " + arg3.str(); break; }
+  case instruction::_FLT : { s = arg1.str() + " = " + arg2.str() + " <. " + arg3.str(); break; }
+  case instruction::_FLE : { s =  arg1.str() + " = " + arg2.str() + " <=. " + arg3.str(); break; }
+  case instruction::_FNEG : { s =  arg1.str() + " = -. " + arg2.str(); break; }
+  case instruction::_FLOAT : { s = arg1.str() + " = float " + arg2.str(); break; }
   case instruction::_NOOP : { s = "noop"; break; }
   default : { s = "????"; break; }
   }
@@ -152,6 +193,12 @@ string instruction::dump() const {
   return ind + s;
 }
 
+// print instruction into a stream (an instruction is a single short
+// line, so it is formatted as above and streamed out)
+void instruction::dump(std::ostream &os) const {
+  os << dump();
+}
+
 ////////////////////////////////////////////////////////////////////
 // concatenation of instruction+list (or instruction+instruction, via automatic coertion)
 
@@ -171,17 +218,40 @@ instructionList::instructionList(const instruction &inst) { this->push_back(inst
 instructionList::~instructionList() {}
 
 // concatenation of lists (or list+instruction, via automatic coertion)
-instructionList instructionList::operator||(const instructionList &lst) const {
-  instructionList newlist = (*this);
+instructionList instructionList::operator||(const instructionList &lst) const & {
+  instructionList newlist;
+  newlist.reserve(this->size() + lst.size());
+  newlist.insert(newlist.end(), this->begin(), this->end());
   newlist.insert(newlist.end(), lst.begin(), lst.end());
   return newlist;
 }
 
+// concatenation when the left operand is a temporary: append in place
+// and hand the buffer over, instead of copying both sides
+instructionList instructionList::operator||(const instructionList &lst) && {
+  this->insert(this->end(), lst.begin(), lst.end());
+  return std::move(*this);
+}
+
+// concatenation when both operands are temporaries: also move the
+// instructions of the right operand instead of copying them
+instructionList instructionList::operator||(instructionList &&lst) && {
+  this->insert(this->end(),
+               std::make_move_iterator(lst.begin()),
+               std::make_move_iterator(lst.end()));
+  return std::move(*this);
+}
+
 // print instructionList (for debugging)
 string instructionList::dump() const {
-  string s;  
-  for (auto i : *this ) s += i.dump() + "\n";
-  return s;
+  std::ostringstream oss;
+  dump(oss);
+  return oss.str();
+}
+
+// print instructionList into a stream
+void instructionList::dump(std::ostream &os) const {
+  for (const auto &i : *this) { i.dump(os); os << "\n"; }
 }
 
 
@@ -231,8 +301,26 @@ void subroutine::add_param(const std::string &name, const std::string &type, boo
 }
 /// add new instruction
 void subroutine::add_instruction(const instruction &inst) {
-  if (inst.oper == instruction::_LABEL) labels.insert(make_pair(inst.arg1,instructions.size()));
+  size_t pc = instructions.size();
+  size_t target = no_branch;
+  if (inst.oper == instruction::_LABEL) {
+    labels.insert(make_pair(inst.arg1.str(), pc));
+    // backpatch the jumps that referenced this label before it existed
+    auto p = pendingjumps.find(inst.arg1.str());
+    if (p != pendingjumps.end()) {
+      for (size_t jpc : p->second) branchtargets[jpc] = pc;
+      pendingjumps.erase(p);
+    }
+  }
+  else if (inst.oper == instruction::_UJUMP or inst.oper == instruction::_FJUMP) {
+    const string & lab = (inst.oper == instruction::_UJUMP ? inst.arg1.str() : inst.arg2.str());
+    auto it = labels.find(lab);
+    if (it != labels.end()) target = it->second;           // backward jump
+    else pendingjumps[lab].push_back(pc);                  // forward jump
+  }
   instructions.push_back(inst);
+  branchtargets.push_back(target);
+  ++profiler::instructionsEmitted;
 }
 /// add instruction list to current instructions
 void subroutine::add_instructions(const instructionList &lins) {
@@ -242,39 +330,63 @@ void subroutine::add_instructions(const instructionList &lins) {
 /// set instruction list (overwritting current instructions)
 void subroutine::set_instructions(const instructionList &lins) {
   instructions.clear();
+  labels.clear();
+  branchtargets.clear();
+  pendingjumps.clear();
   this->add_instructions(lins);
 }
 /// get instruction at given program counter
-instruction subroutine::get_instruction_at(size_t pc) const {
-  if (pc>=instructions.size()) return instruction(instruction::_INVALID);
+const instruction & subroutine::get_instruction_at(size_t pc) const {
+  static const instruction invalid(instruction::_INVALID);
+  if (pc>=instructions.size()) return invalid;
   return instructions[pc];
 }
 /// get program counter for given label
 size_t subroutine::get_label_pc(std::string &lab) const { return labels.find(lab)->second; }
-/// get the list of instructions (needed only in LLVMCodeGen)
-instructionList subroutine::get_instructions() const {
+/// get the resolved target of the jump at pc
+size_t subroutine::get_branch_target(size_t pc) const {
+  if (pc >= branchtargets.size()) return no_branch;
+  return branchtargets[pc];
+}
+/// get the resolved target of every instruction
+const std::vector<size_t> & subroutine::get_branch_targets() const { return branchtargets; }
+/// get the list of instructions
+const instructionList & subroutine::get_instructions() const {
   return instructions;
 }
+/// iteration over the instructions
+instructionList::const_iterator subroutine::begin() const {
+  return instructions.begin();
+}
+instructionList::const_iterator subroutine::end() const {
+  return instructions.end();
+}
 /// print (for debugging)
 string subroutine::dump() const {
-  string s;
-  s = "function " + name + "\n";
+  std::ostringstream oss;
+  dump(oss);
+  return oss.str();
+}
+
+/// print into a stream: each instruction is streamed out as it is
+/// formatted instead of being concatenated into one string
+void subroutine::dump(std::ostream &os) const {
+  os << "function " << name << "\n";
   if (not params.empty()) {
-    s += "  params\n" ;
-    for (auto p : params) s += "    " + p.dump() + "\n";
-    s += "  endparams\n\n";
+    os << "  params\n";
+    for (const auto &p : params) os << "    " << p.dump() << "\n";
+    os << "  endparams\n\n";
   }
   if (not vars.empty()) {
-    s += "  vars\n";
-    for (auto v : vars) s += "    " + v.dump() + "\n";
-    s += "  endvars\n\n";
+    os << "  vars\n";
+    for (const auto &v : vars) os << "    " << v.dump() << "\n";
+    os << "  endvars\n\n";
   }
 
   string ind = "  ";
   if (labels.empty()) ind="";
-  for (auto i : instructions) s += ind + i.dump() + "\n";  
-  s += "endfunction\n\n";
-  return s;
+  for (const auto &i : instructions) { os << ind; i.dump(os); os << "\n"; }
+  os << "endfunction\n\n";
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -306,15 +418,31 @@ void code::add_subroutine(const subroutine &s) {
 const std::vector<subroutine> & code::get_subroutine_list() const {
   return subs;
 }
+/// get the list of subroutines for rewriting
+std::vector<subroutine> & code::get_subroutine_list() { return subs; }
+/// iteration over the subroutines
+std::vector<subroutine>::const_iterator code::begin() const {
+  return subs.begin();
+}
+std::vector<subroutine>::const_iterator code::end() const {
+  return subs.end();
+}
 /// print (for debugging)
 string code::dump() const {
-  string c;
-  for (auto s : subs) c += s.dump();
-  return c;
+  std::ostringstream oss;
+  dump(oss);
+  return oss.str();
+}
+
+/// print into a stream, subroutine by subroutine: writing a large
+/// program does not build its whole text in memory first
+void code::dump(std::ostream &os) const {
+  for (const auto &s : subs) s.dump(os);
 }
 /// print the code in LLVM IR
-std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols) const {
-  LLVMCodeGen llvmCode(Types, Symbols, *this);
+std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols,
+                           bool promoteRegisters) const {
+  LLVMCodeGen llvmCode(Types, Symbols, *this, promoteRegisters);
   std::string llvmStr = llvmCode.dumpLLVM();
   return llvmStr;
 }
@@ -322,9 +450,9 @@ std::string code::dumpLLVM(const TypesMgr & Types, const SymTable & Symbols) con
 
 ////////////////////////////////////////////////////////////////////
 /// Static methods to manage counters
-int counters::countIF = 0;
-int counters::countWHILE = 0;
-int counters::countTEMP = 0;
+thread_local int counters::countIF = 0;
+thread_local int counters::countWHILE = 0;
+thread_local int counters::countTEMP = 0;
 
 string counters::newLabelIF() { return std::to_string(++countIF); }
 string counters::newLabelWHILE() { return std::to_string(++countWHILE); }
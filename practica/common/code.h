@@ -28,9 +28,12 @@
 
 #pragma once
 
+#include <iostream>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <vector>
+#include <cstdint>    // std::uint32_t
 #include "TypesMgr.h"
 #include "SymTable.h"
 
@@ -39,6 +42,50 @@
 class instructionList;
 class LLVMCodeGen;
 
+////////////////////////////////////////////////////////////////////
+/// Class operand stores one instruction argument as a small value:
+/// an index into a shared table that keeps each distinct text
+/// (identifier, temporal, label or constant) exactly once. Copying
+/// an operand (and hence an instruction) is a fixed-size copy, with
+/// no heap allocation when instructions move between lists.
+
+class operand {
+public:
+  /// constructors (empty operand, or interning the given text)
+  operand();
+  operand(const std::string &s);
+  operand(const char *s);
+
+  /// get the interned text back
+  const std::string & str() const;
+  /// implicit conversion, so an operand can be passed wherever the
+  /// textual argument used to be expected
+  operator const std::string & () const;
+  /// true if the operand holds the empty text
+  bool empty() const;
+
+  /// index of the interned text in the shared table
+  /// (equal text <=> equal index, so comparisons are integer compares)
+  std::uint32_t id() const;
+
+  bool operator==(const operand &o) const;
+  bool operator!=(const operand &o) const;
+
+private:
+  /// index in the shared table
+  std::uint32_t idx;
+
+  /// shared table of distinct operand texts (entry 0 is "").
+  /// One table per thread: in batch mode each file is compiled and
+  /// dumped entirely on one worker thread, so no locking is needed
+  static thread_local std::vector<std::string> table;
+  /// index to find already interned texts
+  static thread_local std::unordered_map<std::string, std::uint32_t> tableIndex;
+  /// intern s and return its index in the table
+  static std::uint32_t intern(const std::string &s);
+};
+
+
 ////////////////////////////////////////////////////////////////////
 /// Class instruction stores a VM instruction code with its operands
 
@@ -49,12 +96,13 @@ public:
                 _ADD, _SUB, _MUL, _DIV, _EQ, _LT, _LE, _NEG, _NOT, _AND, _OR, _FLOAT,
                 _FADD, _FSUB, _FMUL, _FDIV, _FEQ, _FLT, _FLE, _FNEG,
                 _LOAD, _ILOAD, _CHLOAD, _FLOAD, _XLOAD, _LOADX, _ALOAD, _LOADC, _CLOAD,
-                _READI, _READF, _READC, _WRITEI, _WRITEF, _WRITEC, _WRITES, _WRITELN, _NOOP, _INVALID} Operation;
-  
+                _READI, _READF, _READC, _WRITEI, _WRITEF, _WRITEC, _WRITES, _WRITELN, _NOOP,
+                _ACOPY, _INVALID} Operation;
+
   /// instruction code
   Operation oper;
-  /// arguments
-  std::string arg1, arg2, arg3;
+  /// arguments (interned, see class operand above)
+  operand arg1, arg2, arg3;
   
   /// constructor
   instruction(Operation op,
@@ -134,8 +182,11 @@ public:
   static instruction FLOAD(const std::string &a1, const std::string &a2);
   // create new instruction "a1[a2] = a3" 
   static instruction XLOAD(const std::string &a1, const std::string &a2, const std::string &a3);
-  // create new instruction "a1 = a2[a3]" 
+  // create new instruction "a1 = a2[a3]"
   static instruction LOADX(const std::string &a1, const std::string &a2, const std::string &a3);
+  // create new instruction "acopy a1 a2 a3" (copy the first a3 cells of
+  // array a2 into array a1; a3 is an integer constant)
+  static instruction ACOPY(const std::string &a1, const std::string &a2, const std::string &a3);
   // create new instruction "a1 = &a2" 
   static instruction ALOAD(const std::string &a1, const std::string &a2);
   // create new instruction "a1 = *a2" 
@@ -162,7 +213,9 @@ public:
   static instruction NOOP();
   
   // print instruction
-  std::string dump() const;   
+  std::string dump() const;
+  // print instruction into a stream (no trailing newline)
+  void dump(std::ostream &os) const;
 };
 
 
@@ -175,14 +228,27 @@ public:
   instructionList();
   // constructor from a single instruction
   instructionList(const instruction &);
+  // copies and moves keep the compiler-generated versions (the
+  // user-declared destructor below would otherwise suppress the moves)
+  instructionList(const instructionList &) = default;
+  instructionList(instructionList &&) = default;
+  instructionList & operator=(const instructionList &) = default;
+  instructionList & operator=(instructionList &&) = default;
   // destructor
   ~instructionList();
 
-  // concatenation of lists (or list+instruction, via automatic coertion)
-  instructionList operator||(const instructionList &lst) const;
+  // concatenation of lists (or list+instruction, via automatic coertion).
+  // When the left operand is a temporary (as in any chain of '||') the
+  // right operand is appended into its buffer, so building a sequence of
+  // n instructions costs O(n) appends instead of O(n^2) copies.
+  instructionList operator||(const instructionList &lst) const &;
+  instructionList operator||(const instructionList &lst) &&;
+  instructionList operator||(instructionList &&lst) &&;
 
   // print instructionList
-  std::string dump() const;   
+  std::string dump() const;
+  // print instructionList into a stream
+  void dump(std::ostream &os) const;
 };
 
 
@@ -215,6 +281,13 @@ private:
   instructionList instructions;
   /// map label name -> position in instructions
   std::map<std::string, size_t> labels;
+  /// resolved branch target (a position in 'instructions') of the
+  /// _UJUMP/_FJUMP at each position, no_branch elsewhere. Filled as
+  /// instructions are added, so consumers never resolve label strings
+  std::vector<size_t> branchtargets;
+  /// jumps seen before their label (label -> positions), backpatched
+  /// when the label instruction arrives
+  std::map<std::string, std::vector<size_t>> pendingjumps;
 
 public:
   /// list of local variables
@@ -241,15 +314,31 @@ public:
   /// set instruction list (overwritting current instructions)
   void set_instructions(const instructionList &lins);
   
-  /// get instruction at given program counter in subroutine
-  instruction get_instruction_at(size_t pc) const;
+  /// get instruction at given program counter in subroutine (by
+  /// reference: interpreters call this once per executed step)
+  const instruction & get_instruction_at(size_t pc) const;
   /// get program counter in subroutine for given label
   size_t get_label_pc(std::string &lab) const;
-  /// get the list of instructions (needed only in LLVMCodeGen)
-  instructionList get_instructions() const;
+  /// value in the branch target view for non-jump instructions
+  static const size_t no_branch = size_t(-1);
+  /// get the resolved target of the jump at pc (no_branch if the
+  /// instruction at pc is not a jump)
+  size_t get_branch_target(size_t pc) const;
+  /// get the resolved target of every instruction (parallel to the
+  /// instruction list), for passes that walk the control flow
+  const std::vector<size_t> & get_branch_targets() const;
+  /// get the list of instructions (by reference: consumers iterate
+  /// it in place; copy it explicitly if you mean to rewrite it)
+  const instructionList & get_instructions() const;
+  /// iteration over the instructions, so a subroutine can be the
+  /// range of a for loop directly
+  instructionList::const_iterator begin() const;
+  instructionList::const_iterator end() const;
 
   // print subroutine (params, vars, and instructions)
   std::string dump() const;
+  // print subroutine into a stream, one instruction at a time
+  void dump(std::ostream &os) const;
 };
 
 
@@ -276,11 +365,26 @@ public:
   void add_subroutine(const subroutine &s);
   /// get the list of subroutines (needed only in LLVMCodeGen)
   const std::vector<subroutine> & get_subroutine_list() const;
+  /// get the list of subroutines for rewriting (needed by the
+  /// peephole optimizer)
+  std::vector<subroutine> & get_subroutine_list();
+  /// iteration over the subroutines, so a program can be the range
+  /// of a for loop directly
+  std::vector<subroutine>::const_iterator begin() const;
+  std::vector<subroutine>::const_iterator end() const;
 
   // print code (all info for all subroutines)
   std::string dump() const;
-  /// print the code in LLVM IR
-  std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols) const;
+  /// print code into a stream. The text is streamed out as it is
+  /// formatted, so memory stays flat however large the program is
+  /// (the std::string version above builds the whole text in memory)
+  void dump(std::ostream &os) const;
+  /// print the code in LLVM IR. With 'promoteRegisters' the scalar
+  /// parameters a function never writes keep no alloca slot and are
+  /// read from their argument registers: less IR to emit and no
+  /// memory round trips for them when the module runs unoptimized
+  std::string dumpLLVM(const TypesMgr & Types, const SymTable &Symbols,
+                       bool promoteRegisters = false) const;
   
   // Error codes for "HALT" instruction
   static const std::string INDEX_OUT_OF_RANGE;
@@ -295,9 +399,11 @@ public:
 
 class counters {
 private:
-  static int countIF;
-  static int countWHILE;
-  static int countTEMP;
+  // one set of counters per thread, so concurrent batch compilations
+  // number their temporals and labels exactly as a standalone run would
+  static thread_local int countIF;
+  static thread_local int countWHILE;
+  static thread_local int countTEMP;
 
 public:
   // return id for new label or temp (id is a number, but returned as string
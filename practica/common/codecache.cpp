@@ -0,0 +1,207 @@
+/////////////////////////////////////////////////////////////////
+//
+//    codecache - per-function cache of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <iterator>   // istreambuf_iterator
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstring>    // std::memcpy
+
+#include "codecache.h"
+
+using namespace std;
+
+const char codecache::MAGIC[4] = {'T', 'C', 'H', '1'};
+
+
+namespace {
+
+  /// the string table being built while writing (same scheme as in
+  /// bincode: each distinct text stored once, referenced by index)
+  class strtable {
+  public:
+    uint32_t intern(const string &s) {
+      auto p = index.find(s);
+      if (p != index.end()) return p->second;
+      uint32_t i = texts.size();
+      texts.push_back(s);
+      index.insert(make_pair(s, i));
+      return i;
+    }
+    const vector<string> & get_texts() const { return texts; }
+  private:
+    vector<string> texts;
+    unordered_map<string, uint32_t> index;
+  };
+
+  void put32(ostream &os, uint32_t x) {
+    os.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+  uint32_t get32(const unsigned char *p) {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+  }
+
+}
+
+
+/// FNV-1a hash of a source text; 'seed' chains hashes together
+uint64_t codecache::hash(const string &s, uint64_t seed) {
+  uint64_t h = seed;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+
+/// write the cache to the given file
+void codecache::write(const cachemap &entries, const string &path) {
+  strtable tab;
+  struct subrec { uint32_t name; uint64_t hash; vector<uint32_t> words; };
+  vector<subrec> recs;
+  for (const auto &e : entries) {
+    const subroutine &s = e.second.sub;
+    subrec r;
+    r.name = tab.intern(e.first);
+    r.hash = e.second.hash;
+    r.words.push_back(s.params.size());
+    for (const var &p : s.params) {
+      r.words.push_back(tab.intern(p.name));
+      r.words.push_back(tab.intern(p.type));
+      r.words.push_back(p.nelem);
+    }
+    r.words.push_back(s.vars.size());
+    for (const var &v : s.vars) {
+      r.words.push_back(tab.intern(v.name));
+      r.words.push_back(tab.intern(v.type));
+      r.words.push_back(v.nelem);
+    }
+    const instructionList &ins = s.get_instructions();
+    r.words.push_back(ins.size());
+    for (const instruction &i : ins) {
+      r.words.push_back(i.oper);
+      r.words.push_back(tab.intern(i.arg1.str()));
+      r.words.push_back(tab.intern(i.arg2.str()));
+      r.words.push_back(tab.intern(i.arg3.str()));
+    }
+    recs.push_back(std::move(r));
+  }
+
+  ofstream os(path, ofstream::binary);
+  if (not os) return;   // an unwritable cache is only a lost speedup
+  os.write(MAGIC, sizeof(MAGIC));
+  put32(os, tab.get_texts().size());
+  for (const string &t : tab.get_texts()) {
+    put32(os, t.size());
+    os.write(t.data(), t.size());
+  }
+  put32(os, recs.size());
+  for (const subrec &r : recs) {
+    put32(os, r.name);
+    put32(os, uint32_t(r.hash));
+    put32(os, uint32_t(r.hash >> 32));
+    for (uint32_t w : r.words) put32(os, w);
+  }
+}
+
+
+/// load the cache into 'entries'; false means a cold cache
+bool codecache::load(const string &path, cachemap &entries) {
+  ifstream is(path, ifstream::binary);
+  if (not is) return false;
+  vector<char> buf((istreambuf_iterator<char>(is)),
+                   istreambuf_iterator<char>());
+  const unsigned char *p   = reinterpret_cast<const unsigned char*>(buf.data());
+  const unsigned char *end = p + buf.size();
+
+  // a cache that fails any check below is simply discarded
+  auto need = [&](size_t n) { return size_t(end - p) >= n; };
+
+  if (not need(sizeof(MAGIC) + 4)) return false;
+  if (memcmp(p, MAGIC, sizeof(MAGIC)) != 0) return false;
+  p += sizeof(MAGIC);
+
+  // string table
+  uint32_t numtexts = get32(p); p += 4;
+  vector<string> texts(numtexts);
+  for (uint32_t i = 0; i < numtexts; ++i) {
+    if (not need(4)) return false;
+    uint32_t len = get32(p); p += 4;
+    if (not need(len)) return false;
+    texts[i] = string(reinterpret_cast<const char*>(p), len);
+    p += len;
+  }
+
+  if (not need(4)) return false;
+  uint32_t numentries = get32(p); p += 4;
+  for (uint32_t k = 0; k < numentries; ++k) {
+    if (not need(12)) return false;
+    uint32_t nameidx = get32(p);
+    if (nameidx >= numtexts) return false;
+    uint64_t h = uint64_t(get32(p+4)) | (uint64_t(get32(p+8)) << 32);
+    p += 12;
+    subroutine s(texts[nameidx]);
+    if (not need(4)) return false;
+    uint32_t numparams = get32(p); p += 4;
+    for (uint32_t i = 0; i < numparams; ++i) {
+      if (not need(12)) return false;
+      uint32_t nm = get32(p), ty = get32(p+4);
+      if (nm >= numtexts or ty >= numtexts) return false;
+      s.params.push_back(var(texts[nm], texts[ty], get32(p+8)));
+      p += 12;
+    }
+    if (not need(4)) return false;
+    uint32_t numvars = get32(p); p += 4;
+    for (uint32_t i = 0; i < numvars; ++i) {
+      if (not need(12)) return false;
+      uint32_t nm = get32(p), ty = get32(p+4);
+      if (nm >= numtexts or ty >= numtexts) return false;
+      s.add_var(texts[nm], texts[ty], get32(p+8));
+      p += 12;
+    }
+    if (not need(4)) return false;
+    uint32_t numinstrs = get32(p); p += 4;
+    for (uint32_t i = 0; i < numinstrs; ++i) {
+      if (not need(16)) return false;
+      uint32_t op = get32(p);
+      uint32_t a1 = get32(p+4), a2 = get32(p+8), a3 = get32(p+12);
+      if (op >= instruction::_INVALID) return false;
+      if (a1 >= numtexts or a2 >= numtexts or a3 >= numtexts) return false;
+      s.add_instruction(instruction(instruction::Operation(op),
+                                    texts[a1], texts[a2], texts[a3]));
+      p += 16;
+    }
+    entries.emplace(s.get_name(), entry{h, s});
+  }
+  return true;
+}
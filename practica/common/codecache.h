@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////
+//
+//    codecache - per-function cache of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class codecache keeps, next to each source file, the code
+/// generated for each of its functions together with a hash of the
+/// function's source span. On recompilation (--incremental) a
+/// function whose hash is unchanged gets its subroutine spliced from
+/// the cache instead of re-running CodeGenVisitor over its subtree;
+/// typically only a handful of functions differ between builds.
+///
+/// The hash of a function must also cover the signatures of the
+/// functions it could call (calling conventions leak into the
+/// caller's code), so the driver mixes a digest of every signature in
+/// the module into each per-function hash: editing a body invalidates
+/// one entry, editing any signature invalidates them all.
+///
+/// The file layout reuses the bincode conventions: a string table
+/// followed by fixed-width records, with each subroutine stored
+/// exactly as in a binary program file plus its 64-bit hash. Unlike a
+/// binary program, a cache is disposable: a missing, truncated or
+/// foreign file just means a cold cache, never an error.
+
+class codecache {
+public:
+  /// one cached function: source span hash plus its generated code
+  struct entry {
+    std::uint64_t hash;
+    subroutine    sub;
+  };
+  typedef std::unordered_map<std::string, entry> cachemap;
+
+  /// FNV-1a hash of a source text; 'seed' chains hashes together
+  static std::uint64_t hash(const std::string &s,
+                            std::uint64_t seed = 14695981039346656037ull);
+
+  /// load the cache into 'entries'; false means a cold cache
+  static bool load(const std::string &path, cachemap &entries);
+  /// write the cache to the given file
+  static void write(const cachemap &entries, const std::string &path);
+
+private:
+  /// first bytes of every cache file
+  static const char MAGIC[4];
+};
@@ -0,0 +1,193 @@
+/////////////////////////////////////////////////////////////////
+//
+//    iobuf - buffered, locale-free I/O for interpreted programs
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "iobuf.h"
+
+#include <cstdio>     // std::snprintf
+#include <cstdlib>    // std::strtof
+#include <cstring>    // std::memcpy
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation of class 'iobuf'
+
+/// size of each buffer (one stream write/read per this many bytes)
+static const size_t BUF_BYTES = 1 << 16;
+
+/// constructor
+iobuf::iobuf(istream &in, ostream &out)
+  : in(in), out(out),
+    obuf(BUF_BYTES), opos(0),
+    ibuf(BUF_BYTES), ipos(0), ilen(0) {
+}
+
+/// destructor: whatever is pending reaches the stream
+iobuf::~iobuf() {
+  flush();
+}
+
+/// append to the output buffer, draining it when full
+void iobuf::put(char c) {
+  if (opos == obuf.size()) drain();
+  obuf[opos++] = c;
+}
+
+void iobuf::puttext(const char *s, size_t n) {
+  while (n > 0) {
+    if (opos == obuf.size()) drain();
+    size_t room = obuf.size() - opos;
+    size_t take = n < room ? n : room;
+    memcpy(obuf.data() + opos, s, take);
+    opos += take;
+    s += take;
+    n -= take;
+  }
+}
+
+/// hand the buffered output to the stream (without flushing it)
+void iobuf::drain() {
+  if (opos > 0) out.write(obuf.data(), opos);
+  opos = 0;
+}
+
+/// hand the buffered output to the stream and flush it
+void iobuf::flush() {
+  drain();
+  out.flush();
+}
+
+/// integers are formatted by hand: same text as 'out << v', with no
+/// locale in the way
+void iobuf::writei(int v) {
+  char digits[12];
+  size_t n = 0;
+  // accumulate on a long so the minimum int negates safely
+  long l = v;
+  if (l < 0) { put('-'); l = -l; }
+  do {
+    digits[n++] = char('0' + l % 10);
+    l /= 10;
+  } while (l > 0);
+  while (n > 0) put(digits[--n]);
+}
+
+/// floats take the '%g' path of the C library, which is what the
+/// stream operator prints under the default formatting flags
+void iobuf::writef(float v) {
+  char text[32];
+  int n = snprintf(text, sizeof(text), "%g", double(v));
+  puttext(text, n);
+}
+
+void iobuf::writec(char c) {
+  put(c);
+}
+
+void iobuf::writes(const string &s) {
+  puttext(s.data(), s.size());
+}
+
+void iobuf::writeln() {
+  put('\n');
+}
+
+/// next input byte without/with consuming it (-1 at end of input)
+int iobuf::peekbyte() {
+  if (ipos >= ilen) {
+    in.read(ibuf.data(), ibuf.size());
+    ilen = in.gcount();
+    ipos = 0;
+    if (ilen == 0) return -1;
+  }
+  return (unsigned char)ibuf[ipos];
+}
+
+int iobuf::getbyte() {
+  int c = peekbyte();
+  if (c >= 0) ++ipos;
+  return c;
+}
+
+/// position the input on the first non-whitespace byte
+void iobuf::skipws() {
+  int c = peekbyte();
+  while (c == ' ' or c == '\t' or c == '\n' or c == '\r' or
+         c == '\f' or c == '\v') {
+    ++ipos;
+    c = peekbyte();
+  }
+}
+
+/// the reads push the pending output to the stream first, so a
+/// prompt written just before is visible when the program blocks
+
+void iobuf::readi(int &v) {
+  flush();
+  skipws();
+  bool negative = false;
+  int c = peekbyte();
+  if (c == '-' or c == '+') {
+    negative = (c == '-');
+    ++ipos;
+    c = peekbyte();
+  }
+  long l = 0;
+  while (c >= '0' and c <= '9') {
+    l = l * 10 + (c - '0');
+    ++ipos;
+    c = peekbyte();
+  }
+  v = int(negative ? -l : l);
+}
+
+void iobuf::readf(float &v) {
+  flush();
+  skipws();
+  // collect the token and let the C library parse it
+  char text[64];
+  size_t n = 0;
+  int c = peekbyte();
+  while (n + 1 < sizeof(text) and
+         ((c >= '0' and c <= '9') or c == '-' or c == '+' or
+          c == '.' or c == 'e' or c == 'E')) {
+    text[n++] = char(c);
+    ++ipos;
+    c = peekbyte();
+  }
+  text[n] = '\0';
+  v = strtof(text, nullptr);
+}
+
+void iobuf::readc(char &c) {
+  flush();
+  skipws();
+  int b = getbyte();
+  c = b < 0 ? '\0' : char(b);
+}
@@ -0,0 +1,93 @@
+/////////////////////////////////////////////////////////////////
+//
+//    iobuf - buffered, locale-free I/O for interpreted programs
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class iobuf wraps the streams the interpreter reads and writes
+/// with its own block buffers and locale-free formatting. The stream
+/// operators pay a locale and sentry round trip per value, and the
+/// interpreter used to end every line with an explicit flush; an
+/// I/O-heavy program crossed into the runtime millions of times.
+/// Here each value is formatted into a buffer handed to the stream
+/// in large writes, and input is taken in large reads and parsed in
+/// place. Formats match the defaults of the stream operators, so the
+/// produced output is unchanged.
+/// Written output is pushed to the stream before every read (so
+/// prompts appear before the program blocks) and when the object
+/// goes out of scope.
+
+class iobuf {
+public:
+  /// constructor and destructor (the destructor drains the buffer)
+  iobuf(std::istream &in, std::ostream &out);
+  ~iobuf();
+
+  /// formatted output (the counterparts of 'out <<')
+  void writei(int v);
+  void writef(float v);
+  void writec(char c);
+  void writes(const std::string &s);
+  void writeln();
+  /// hand the buffered output to the stream and flush it
+  void flush();
+
+  /// formatted input (the counterparts of 'in >>': leading
+  /// whitespace is skipped, a failed read leaves a zero value)
+  void readi(int &v);
+  void readf(float &v);
+  void readc(char &c);
+
+private:
+  std::istream &in;
+  std::ostream &out;
+
+  /// output buffer and the number of bytes pending in it
+  std::vector<char> obuf;
+  std::size_t opos;
+  /// input buffer, the read position and the number of valid bytes
+  std::vector<char> ibuf;
+  std::size_t ipos, ilen;
+
+  /// append to the output buffer, draining it when full
+  void put(char c);
+  void puttext(const char *s, std::size_t n);
+  /// hand the buffered output to the stream (without flushing it)
+  void drain();
+
+  /// next input byte without/with consuming it (-1 at end of input)
+  int peekbyte();
+  int getbyte();
+  /// position the input on the first non-whitespace byte
+  void skipws();
+};
@@ -0,0 +1,758 @@
+/////////////////////////////////////////////////////////////////
+//
+//    peephole - local optimization of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "peephole.h"
+#include "cfg.h"
+
+#include <cstdlib>    // strtol, strtof
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation of class 'peephole'
+
+/// optimize every subroutine of the program
+void peephole::optimize(code &c) {
+  for (auto & s : c.get_subroutine_list())
+    optimize_subroutine(s);
+}
+
+/// run the passes over one subroutine until nothing changes
+void peephole::optimize_subroutine(subroutine &s) {
+  instructionList l = s.get_instructions();
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    changed = fold_constants(l)        or changed;
+    changed = reuse_subexpressions(l)  or changed;
+    changed = forward_copies(l)        or changed;
+    changed = forward_results(l)       or changed;
+    changed = remove_dead_temporals(l) or changed;
+    changed = collapse_jumps(l)        or changed;
+  }
+  s.set_instructions(l);
+  // with the labels and branch targets rebuilt, drop whatever blocks
+  // no control path reaches
+  remove_unreachable(s);
+}
+
+/// drop the basic blocks that no control path reaches
+bool peephole::remove_unreachable(subroutine &s) {
+  cfg g(s);
+  const vector<bool> & reach = g.reachable();
+  bool all = true;
+  for (bool r : reach) all = all and r;
+  if (all) return false;
+
+  const instructionList & l = s.get_instructions();
+  instructionList kept;
+  for (size_t b = 0; b < g.get_blocks().size(); ++b) {
+    if (not reach[b]) continue;
+    for (size_t k = g.get_blocks()[b].first; k < g.get_blocks()[b].last; ++k)
+      kept.push_back(l[k]);
+  }
+  s.set_instructions(kept);
+  return true;
+}
+
+/// renumber the temporals of every subroutine
+void peephole::recycle_temps(code &c) {
+  for (auto & s : c.get_subroutine_list())
+    recycle_subroutine(s);
+}
+
+/// renumber the temporals of one subroutine, reusing the number of
+/// every temporal whose last appearance is already past
+void peephole::recycle_subroutine(subroutine &s) {
+  instructionList l = s.get_instructions();
+  const vector<size_t> & targets = s.get_branch_targets();
+
+  // first and last position where each temporal appears (a map keeps
+  // the scan order deterministic)
+  map<string, pair<size_t, size_t>> range;
+  for (size_t k = 0; k < l.size(); ++k) {
+    const operand *args[] = { &l[k].arg1, &l[k].arg2, &l[k].arg3 };
+    for (auto o : args) {
+      if (not is_temp(o->str())) continue;
+      auto it = range.find(o->str());
+      if (it == range.end()) range[o->str()] = make_pair(k, k);
+      else it->second.second = k;
+    }
+  }
+
+  // a backward jump re-executes the instructions from its target: a
+  // temporal defined before the target but still used after it is
+  // needed on every pass, so its range grows up to the jump. One
+  // defined after the target is rewritten before its uses on each
+  // pass and needs no extension (ranges grow to a fixpoint, for
+  // nested loops)
+  bool grown = true;
+  while (grown) {
+    grown = false;
+    for (size_t k = 0; k < targets.size(); ++k) {
+      if (targets[k] == subroutine::no_branch or targets[k] >= k) continue;
+      for (auto & r : range)
+        if (r.second.first < targets[k] and targets[k] <= r.second.second
+            and r.second.second < k) {
+          r.second.second = k;
+          grown = true;
+        }
+    }
+  }
+
+  // linear scan in order of first appearance: take the lowest free
+  // number, give it back once the last appearance is past
+  vector<pair<size_t, const string *>> order;
+  for (auto & r : range) order.push_back(make_pair(r.second.first, &r.first));
+  sort(order.begin(), order.end());
+  priority_queue<int, vector<int>, greater<int>> freenums;
+  vector<pair<size_t, int>> active;   // (last appearance, number)
+  int highest = 0;
+  unordered_map<string, string> newname;
+  for (auto & d : order) {
+    for (size_t a = active.size(); a-- > 0; )
+      if (active[a].first < d.first) {
+        freenums.push(active[a].second);
+        active.erase(active.begin() + a);
+      }
+    int num;
+    if (not freenums.empty()) { num = freenums.top(); freenums.pop(); }
+    else num = ++highest;
+    newname[*d.second] = "%" + std::to_string(num);
+    active.push_back(make_pair(range[*d.second].second, num));
+  }
+
+  for (auto & ins : l) {
+    operand *args[] = { &ins.arg1, &ins.arg2, &ins.arg3 };
+    for (auto o : args) {
+      auto it = newname.find(o->str());
+      if (it != newname.end()) *o = it->second;
+    }
+  }
+  s.set_instructions(l);
+}
+
+/// fuse the whole-array copy loops of every subroutine
+void peephole::fuse_array_copies(code &c) {
+  for (auto & s : c.get_subroutine_list()) {
+    instructionList l = s.get_instructions();
+    if (fuse_subroutine_copies(l)) s.set_instructions(l);
+  }
+}
+
+/// fuse the whole-array copy loops of one subroutine. The code
+/// generator lowers 'a = b' on arrays to a fixed eleven-instruction
+/// counting loop; every occurrence whose temporals and labels appear
+/// nowhere else becomes a single 'acopy a b n'
+bool peephole::fuse_subroutine_copies(instructionList &l) {
+  bool changed = false;
+  for (size_t k = 0; k + 11 <= l.size(); ++k) {
+    // the shape of the loop, position by position
+    if (l[k].oper    != instruction::_ILOAD or l[k].arg2.str() != "0") continue;
+    if (l[k+1].oper  != instruction::_ILOAD) continue;
+    if (l[k+2].oper  != instruction::_ILOAD or l[k+2].arg2.str() != "1") continue;
+    if (l[k+3].oper  != instruction::_LABEL) continue;
+    if (l[k+4].oper  != instruction::_LT)    continue;
+    if (l[k+5].oper  != instruction::_FJUMP) continue;
+    if (l[k+6].oper  != instruction::_LOADX) continue;
+    if (l[k+7].oper  != instruction::_XLOAD) continue;
+    if (l[k+8].oper  != instruction::_ADD)   continue;
+    if (l[k+9].oper  != instruction::_UJUMP) continue;
+    if (l[k+10].oper != instruction::_LABEL) continue;
+
+    const string idx  = l[k].arg1.str();     // loop counter
+    const string size = l[k+1].arg1.str();   // element count
+    const string incr = l[k+2].arg1.str();   // constant one
+    const string comp = l[k+4].arg1.str();   // comparison result
+    const string val  = l[k+6].arg1.str();   // element being carried
+    const string head = l[k+3].arg1.str();   // loop entry label
+    const string out  = l[k+10].arg1.str();  // loop exit label
+    if (not is_temp(idx) or not is_temp(size) or not is_temp(incr) or
+        not is_temp(comp) or not is_temp(val)) continue;
+
+    // how the instructions are wired together
+    if (l[k+4].arg2.str() != idx  or l[k+4].arg3.str() != size) continue;
+    if (l[k+5].arg1.str() != comp or l[k+5].arg2.str() != out)  continue;
+    if (l[k+6].arg3.str() != idx) continue;
+    if (l[k+7].arg2.str() != idx or l[k+7].arg3.str() != val)   continue;
+    if (l[k+8].arg1.str() != idx or l[k+8].arg2.str() != idx or
+        l[k+8].arg3.str() != incr) continue;
+    if (l[k+9].arg1.str() != head) continue;
+
+    // the temporals and labels must be private to the loop
+    bool isolated = true;
+    for (size_t j = 0; j < l.size() and isolated; ++j) {
+      if (j >= k and j < k + 11) continue;
+      const operand *args[] = { &l[j].arg1, &l[j].arg2, &l[j].arg3 };
+      for (auto o : args)
+        if (o->str() == idx or o->str() == size or o->str() == incr or
+            o->str() == comp or o->str() == val or
+            o->str() == head or o->str() == out) isolated = false;
+    }
+    if (not isolated) continue;
+
+    l[k] = instruction::ACOPY(l[k+7].arg1.str(), l[k+6].arg2.str(),
+                              l[k+1].arg2.str());
+    l.erase(l.begin() + k + 1, l.begin() + k + 11);
+    changed = true;
+  }
+  return changed;
+}
+
+/// is this the name of a code generator temporal?
+bool peephole::is_temp(const string &name) {
+  return not name.empty() and name[0] == '%';
+}
+
+/// does this instruction write the temporal/variable in arg1?
+bool peephole::writes_arg1(const instruction &ins) {
+  switch (ins.oper) {
+  case instruction::_ADD:   case instruction::_SUB:
+  case instruction::_MUL:   case instruction::_DIV:
+  case instruction::_EQ:    case instruction::_LT:   case instruction::_LE:
+  case instruction::_AND:   case instruction::_OR:
+  case instruction::_FADD:  case instruction::_FSUB:
+  case instruction::_FMUL:  case instruction::_FDIV:
+  case instruction::_FEQ:   case instruction::_FLT:  case instruction::_FLE:
+  case instruction::_NOT:   case instruction::_NEG:  case instruction::_FNEG:
+  case instruction::_FLOAT:
+  case instruction::_LOAD:  case instruction::_ILOAD:
+  case instruction::_CHLOAD: case instruction::_FLOAD:
+  case instruction::_LOADX: case instruction::_ALOAD:
+  case instruction::_LOADC:
+  case instruction::_READI: case instruction::_READF:
+  case instruction::_READC:
+    return true;
+  case instruction::_POP:
+    return not ins.arg1.empty();
+  default:
+    return false;
+  }
+}
+
+/// can this instruction be removed when its result is unused?
+/// (reads and pops also write arg1, but have side effects)
+bool peephole::is_pure(const instruction &ins) {
+  switch (ins.oper) {
+  case instruction::_READI: case instruction::_READF:
+  case instruction::_READC: case instruction::_POP:
+    return false;
+  default:
+    return writes_arg1(ins);
+  }
+}
+
+/// does this instruction read the given name (in any operand)?
+bool peephole::reads(const instruction &ins, const string &name) {
+  switch (ins.oper) {
+  // binary operations read arg2 and arg3
+  case instruction::_ADD:   case instruction::_SUB:
+  case instruction::_MUL:   case instruction::_DIV:
+  case instruction::_EQ:    case instruction::_LT:   case instruction::_LE:
+  case instruction::_AND:   case instruction::_OR:
+  case instruction::_FADD:  case instruction::_FSUB:
+  case instruction::_FMUL:  case instruction::_FDIV:
+  case instruction::_FEQ:   case instruction::_FLT:  case instruction::_FLE:
+    return ins.arg2.str() == name or ins.arg3.str() == name;
+  // unary operations and copies read arg2
+  case instruction::_NOT:   case instruction::_NEG:  case instruction::_FNEG:
+  case instruction::_FLOAT: case instruction::_LOAD:
+  case instruction::_ALOAD: case instruction::_LOADC:
+    return ins.arg2.str() == name;
+  // indexed accesses and bulk copies also read their array bases
+  case instruction::_XLOAD:
+  case instruction::_ACOPY:
+    return ins.arg1.str() == name or ins.arg2.str() == name
+        or ins.arg3.str() == name;
+  case instruction::_LOADX:
+    return ins.arg2.str() == name or ins.arg3.str() == name;
+  case instruction::_CLOAD:
+    return ins.arg1.str() == name or ins.arg2.str() == name;
+  // control and i/o read arg1
+  case instruction::_FJUMP: case instruction::_PUSH:
+  case instruction::_WRITEI: case instruction::_WRITEF:
+  case instruction::_WRITEC:
+    return ins.arg1.str() == name;
+  default:
+    return false;
+  }
+}
+
+/// replace reads of 'from' with 'to' where it is safe to do so.
+/// Array base operands (XLOAD arg1, LOADX arg2, ALOAD arg2) are left
+/// untouched: they name a container, not a value
+bool peephole::replace_reads(instruction &ins, const string &from,
+                             const string &to) {
+  bool changed = false;
+  switch (ins.oper) {
+  case instruction::_ADD:   case instruction::_SUB:
+  case instruction::_MUL:   case instruction::_DIV:
+  case instruction::_EQ:    case instruction::_LT:   case instruction::_LE:
+  case instruction::_AND:   case instruction::_OR:
+  case instruction::_FADD:  case instruction::_FSUB:
+  case instruction::_FMUL:  case instruction::_FDIV:
+  case instruction::_FEQ:   case instruction::_FLT:  case instruction::_FLE:
+    if (ins.arg2.str() == from) { ins.arg2 = to; changed = true; }
+    if (ins.arg3.str() == from) { ins.arg3 = to; changed = true; }
+    break;
+  case instruction::_NOT:   case instruction::_NEG:  case instruction::_FNEG:
+  case instruction::_FLOAT: case instruction::_LOAD:
+  case instruction::_LOADC:
+    if (ins.arg2.str() == from) { ins.arg2 = to; changed = true; }
+    break;
+  case instruction::_XLOAD:
+    if (ins.arg2.str() == from) { ins.arg2 = to; changed = true; }
+    if (ins.arg3.str() == from) { ins.arg3 = to; changed = true; }
+    break;
+  case instruction::_LOADX:
+    if (ins.arg3.str() == from) { ins.arg3 = to; changed = true; }
+    break;
+  case instruction::_CLOAD:
+    if (ins.arg1.str() == from) { ins.arg1 = to; changed = true; }
+    if (ins.arg2.str() == from) { ins.arg2 = to; changed = true; }
+    break;
+  case instruction::_FJUMP: case instruction::_PUSH:
+  case instruction::_WRITEI: case instruction::_WRITEF:
+  case instruction::_WRITEC:
+    if (ins.arg1.str() == from) { ins.arg1 = to; changed = true; }
+    break;
+  default:
+    break;
+  }
+  return changed;
+}
+
+/// forward 'LOAD t,x' copies: inside the basic block, later reads of
+/// the temporal t can use x directly, as long as neither t nor x can
+/// have changed in between. The LOAD itself disappears later, through
+/// remove_dead_temporals, once no read of t remains
+bool peephole::forward_copies(instructionList &l) {
+  bool changed = false;
+  for (size_t k = 0; k < l.size(); ++k) {
+    if (l[k].oper != instruction::_LOAD) continue;
+    const string t = l[k].arg1.str();
+    const string x = l[k].arg2.str();
+    if (not is_temp(t) or t == x) continue;
+    for (size_t j = k+1; j < l.size(); ++j) {
+      instruction & ins = l[j];
+      changed = replace_reads(ins, t, x) or changed;
+      // a label or a (possibly taken) jump ends the basic block
+      if (ins.oper == instruction::_LABEL or
+          ins.oper == instruction::_UJUMP or
+          ins.oper == instruction::_FJUMP or
+          ins.oper == instruction::_RETURN or
+          ins.oper == instruction::_HALT) break;
+      // a store through an address or into an array could change x
+      // when x is a declared variable (temporals are never aliased)
+      if ((ins.oper == instruction::_CLOAD or
+           ins.oper == instruction::_XLOAD) and not is_temp(x)) break;
+      // past this instruction t or x no longer hold the same value
+      if (writes_arg1(ins) and
+          (ins.arg1.str() == t or ins.arg1.str() == x)) break;
+    }
+  }
+  return changed;
+}
+
+/// rewrite 't = a op b' immediately followed by 'x = t' into
+/// 'x = a op b', when t is a temporal read only by that copy
+bool peephole::forward_results(instructionList &l) {
+  bool changed = false;
+  for (size_t k = 0; k+1 < l.size(); ++k) {
+    if (l[k+1].oper != instruction::_LOAD) continue;
+    const string t = l[k+1].arg2.str();
+    const string x = l[k+1].arg1.str();
+    if (not is_temp(t) or t == x) continue;
+    if (not is_pure(l[k]) or l[k].arg1.str() != t) continue;
+    // t must be written once (here) and read once (by the copy)
+    size_t nreads = 0, nwrites = 0;
+    for (auto & ins : l) {
+      if (reads(ins, t)) ++nreads;
+      if (writes_arg1(ins) and ins.arg1.str() == t) ++nwrites;
+    }
+    if (nreads != 1 or nwrites != 1) continue;
+    l[k].arg1 = x;
+    l.erase(l.begin() + (k+1));
+    changed = true;
+  }
+  return changed;
+}
+
+/// remove side-effect-free instructions whose target temporal is
+/// never read
+bool peephole::remove_dead_temporals(instructionList &l) {
+  // count the reads of every temporal in one sweep
+  unordered_map<string, size_t> nreads;
+  for (auto & ins : l) {
+    if (reads(ins, ins.arg1.str()) and is_temp(ins.arg1.str())) ++nreads[ins.arg1.str()];
+    if (reads(ins, ins.arg2.str()) and is_temp(ins.arg2.str())) ++nreads[ins.arg2.str()];
+    if (reads(ins, ins.arg3.str()) and is_temp(ins.arg3.str())) ++nreads[ins.arg3.str()];
+  }
+  bool changed = false;
+  for (size_t k = l.size(); k-- > 0; ) {
+    if (is_pure(l[k]) and is_temp(l[k].arg1.str())
+        and nreads.find(l[k].arg1.str()) == nreads.end()) {
+      l.erase(l.begin() + k);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+/// reuse the result of an identical earlier computation: when the
+/// same operation over the same (unchanged) sources appears again in
+/// a basic block, the repeat becomes a copy of the first result. The
+/// copy is then cleaned up by forward_copies/remove_dead_temporals.
+/// Element loads (LOADX/LOADC) are reused too, but only until any
+/// store into memory or call, which could change what they read
+bool peephole::reuse_subexpressions(instructionList &l) {
+  bool changed = false;
+  // available computations: textual key -> name holding the result
+  map<string, string> avail;
+
+  // drop every available computation that involves this name
+  auto invalidate = [&avail](const string &name) {
+    for (auto it = avail.begin(); it != avail.end(); ) {
+      if (it->first.find("|" + name + "|") != string::npos
+          or it->second == name) it = avail.erase(it);
+      else ++it;
+    }
+  };
+  // drop the computations that read memory
+  auto invalidate_memory = [&avail]() {
+    for (auto it = avail.begin(); it != avail.end(); ) {
+      if (it->first.compare(0, 2, "M|") == 0) it = avail.erase(it);
+      else ++it;
+    }
+  };
+
+  for (auto & ins : l) {
+    // a label or a jump ends the basic block
+    if (ins.oper == instruction::_LABEL or
+        ins.oper == instruction::_UJUMP or
+        ins.oper == instruction::_FJUMP) {
+      avail.clear();
+      continue;
+    }
+    string key;
+    switch (ins.oper) {
+    case instruction::_ADD:   case instruction::_SUB:
+    case instruction::_MUL:   case instruction::_DIV:
+    case instruction::_EQ:    case instruction::_LT:   case instruction::_LE:
+    case instruction::_AND:   case instruction::_OR:
+    case instruction::_FADD:  case instruction::_FSUB:
+    case instruction::_FMUL:  case instruction::_FDIV:
+    case instruction::_FEQ:   case instruction::_FLT:  case instruction::_FLE:
+      key = std::to_string(ins.oper) + "|" + ins.arg2.str() + "|"
+          + ins.arg3.str() + "|";
+      break;
+    case instruction::_NOT:   case instruction::_NEG:  case instruction::_FNEG:
+    case instruction::_FLOAT: case instruction::_ALOAD:
+      key = std::to_string(ins.oper) + "|" + ins.arg2.str() + "|";
+      break;
+    // memory reads are reusable until memory may change
+    case instruction::_LOADX:
+      key = "M|" + std::to_string(ins.oper) + "|" + ins.arg2.str() + "|"
+          + ins.arg3.str() + "|";
+      break;
+    case instruction::_LOADC:
+      key = "M|" + std::to_string(ins.oper) + "|" + ins.arg2.str() + "|";
+      break;
+    default:
+      break;
+    }
+    if (not key.empty()) {
+      auto it = avail.find(key);
+      if (it != avail.end() and it->second != ins.arg1.str()) {
+        ins = instruction::LOAD(ins.arg1.str(), it->second);
+        changed = true;
+      }
+      else {
+        const string dest = ins.arg1.str();
+        invalidate(dest);
+        // do not record a computation that overwrites its own source
+        if (key.find("|" + dest + "|") == string::npos) avail[key] = dest;
+        continue;
+      }
+    }
+    // stores and calls may change what memory reads would return
+    if (ins.oper == instruction::_XLOAD or
+        ins.oper == instruction::_CLOAD or
+        ins.oper == instruction::_CALL) invalidate_memory();
+    if (writes_arg1(ins)) invalidate(ins.arg1.str());
+  }
+  return changed;
+}
+
+
+/// a constant value known for a temporal/variable at some point of
+/// a basic block. The original text is kept so a propagated constant
+/// is re-emitted exactly as it was written (in particular character
+/// constants keep their quoted form)
+namespace {
+  struct constval {
+    enum { INT, FLT, CHR } kind;
+    int         i;
+    float       f;
+    std::string text;
+  };
+}
+
+/// fold operations whose sources hold known constants into a single
+/// constant load. Known constants are tracked per basic block, so
+/// chains like ILOAD+ILOAD+ADD coming from literal index arithmetic
+/// collapse into one ILOAD (and then feed further folds)
+bool peephole::fold_constants(instructionList &l) {
+  bool changed = false;
+  unordered_map<string, constval> known;
+
+  // the known constant behind a name, if any
+  auto find = [&known](const operand &o) -> const constval * {
+    auto it = known.find(o.str());
+    return it == known.end() ? nullptr : &it->second;
+  };
+  // record the constant now held by the target of l[k], which the
+  // instruction there must keep writing
+  auto record = [&known](const instruction &ins, constval v) {
+    known[ins.arg1.str()] = v;
+  };
+  auto intconst = [](int i) {
+    constval v; v.kind = constval::INT; v.i = i; v.f = 0.0;
+    v.text = std::to_string(i);
+    return v;
+  };
+  auto fltconst = [](float f) {
+    constval v; v.kind = constval::FLT; v.i = 0; v.f = f;
+    v.text = std::to_string(f);
+    return v;
+  };
+
+  for (size_t k = 0; k < l.size(); ++k) {
+    instruction & ins = l[k];
+    // a label or a jump ends the basic block
+    if (ins.oper == instruction::_LABEL or
+        ins.oper == instruction::_UJUMP or
+        ins.oper == instruction::_FJUMP) {
+      known.clear();
+      continue;
+    }
+    const constval *c2 = find(ins.arg2);
+    const constval *c3 = find(ins.arg3);
+    switch (ins.oper) {
+    // constant loads introduce known values
+    case instruction::_ILOAD:
+      record(ins, intconst(std::strtol(ins.arg2.str().c_str(), nullptr, 10)));
+      continue;
+    case instruction::_FLOAD: {
+      constval v; v.kind = constval::FLT; v.i = 0;
+      v.f = std::strtof(ins.arg2.str().c_str(), nullptr);
+      v.text = ins.arg2.str();
+      record(ins, v);
+      continue;
+    }
+    case instruction::_CHLOAD: {
+      constval v; v.kind = constval::CHR; v.i = 0; v.f = 0.0;
+      v.text = ins.arg2.str();
+      record(ins, v);
+      continue;
+    }
+    // a copy of a known constant becomes a constant load itself
+    case instruction::_LOAD:
+      if (c2 != nullptr) {
+        instruction::Operation op =
+          (c2->kind == constval::INT ? instruction::_ILOAD :
+           c2->kind == constval::FLT ? instruction::_FLOAD
+                                     : instruction::_CHLOAD);
+        ins = instruction(op, ins.arg1.str(), c2->text);
+        known[ins.arg1.str()] = *c2;
+        changed = true;
+        continue;
+      }
+      break;
+    // integer arithmetic and comparisons
+    case instruction::_ADD: case instruction::_SUB:
+    case instruction::_MUL: case instruction::_DIV:
+    case instruction::_EQ:  case instruction::_LT: case instruction::_LE:
+    case instruction::_AND: case instruction::_OR:
+      if (c2 != nullptr and c3 != nullptr and
+          c2->kind == constval::INT and c3->kind == constval::INT and
+          not (ins.oper == instruction::_DIV and c3->i == 0)) {
+        int r = 0;
+        switch (ins.oper) {
+        case instruction::_ADD: r = c2->i +   c3->i; break;
+        case instruction::_SUB: r = c2->i -   c3->i; break;
+        case instruction::_MUL: r = c2->i *   c3->i; break;
+        case instruction::_DIV: r = c2->i /   c3->i; break;
+        case instruction::_EQ:  r = c2->i ==  c3->i; break;
+        case instruction::_LT:  r = c2->i <   c3->i; break;
+        case instruction::_LE:  r = c2->i <=  c3->i; break;
+        case instruction::_AND: r = c2->i and c3->i; break;
+        default:                r = c2->i or  c3->i; break;
+        }
+        ins = instruction(instruction::_ILOAD, ins.arg1.str(),
+                          std::to_string(r));
+        record(ins, intconst(r));
+        changed = true;
+        continue;
+      }
+      break;
+    // float arithmetic and comparisons
+    case instruction::_FADD: case instruction::_FSUB:
+    case instruction::_FMUL: case instruction::_FDIV:
+    case instruction::_FEQ:  case instruction::_FLT: case instruction::_FLE:
+      if (c2 != nullptr and c3 != nullptr and
+          c2->kind == constval::FLT and c3->kind == constval::FLT and
+          not (ins.oper == instruction::_FDIV and c3->f == 0.0)) {
+        if (ins.oper == instruction::_FEQ or
+            ins.oper == instruction::_FLT or
+            ins.oper == instruction::_FLE) {
+          int r = (ins.oper == instruction::_FEQ ? c2->f == c3->f :
+                   ins.oper == instruction::_FLT ? c2->f <  c3->f
+                                                 : c2->f <= c3->f);
+          ins = instruction(instruction::_ILOAD, ins.arg1.str(),
+                            std::to_string(r));
+          record(ins, intconst(r));
+        }
+        else {
+          float r = (ins.oper == instruction::_FADD ? c2->f + c3->f :
+                     ins.oper == instruction::_FSUB ? c2->f - c3->f :
+                     ins.oper == instruction::_FMUL ? c2->f * c3->f
+                                                    : c2->f / c3->f);
+          ins = instruction(instruction::_FLOAD, ins.arg1.str(),
+                            std::to_string(r));
+          record(ins, fltconst(r));
+        }
+        changed = true;
+        continue;
+      }
+      break;
+    // unary operations
+    case instruction::_NOT: case instruction::_NEG:
+      if (c2 != nullptr and c2->kind == constval::INT) {
+        int r = (ins.oper == instruction::_NOT ? not c2->i : - c2->i);
+        ins = instruction(instruction::_ILOAD, ins.arg1.str(),
+                          std::to_string(r));
+        record(ins, intconst(r));
+        changed = true;
+        continue;
+      }
+      break;
+    case instruction::_FNEG:
+      if (c2 != nullptr and c2->kind == constval::FLT) {
+        float r = - c2->f;
+        ins = instruction(instruction::_FLOAD, ins.arg1.str(),
+                          std::to_string(r));
+        record(ins, fltconst(r));
+        changed = true;
+        continue;
+      }
+      break;
+    case instruction::_FLOAT:
+      if (c2 != nullptr and c2->kind == constval::INT) {
+        float r = float(c2->i);
+        ins = instruction(instruction::_FLOAD, ins.arg1.str(),
+                          std::to_string(r));
+        record(ins, fltconst(r));
+        changed = true;
+        continue;
+      }
+      break;
+    default:
+      break;
+    }
+    // anything else that writes its target makes its value unknown
+    if (writes_arg1(ins)) known.erase(ins.arg1.str());
+  }
+  return changed;
+}
+
+
+/// retarget jumps whose destination is another unconditional jump,
+/// and remove jumps to the instruction that follows them
+bool peephole::collapse_jumps(instructionList &l) {
+  map<string, size_t> labelpc;
+  for (size_t k = 0; k < l.size(); ++k)
+    if (l[k].oper == instruction::_LABEL) labelpc[l[k].arg1.str()] = k;
+
+  // follow a label through labels/noops to the first real
+  // instruction; if that is an unconditional jump, take its label
+  // instead (bounded, in case of a cycle of jumps)
+  auto final_label = [&l, &labelpc](string lab) -> string {
+    for (size_t steps = 0; steps <= l.size(); ++steps) {
+      auto it = labelpc.find(lab);
+      if (it == labelpc.end()) return lab;
+      size_t pc = it->second;
+      while (pc < l.size() and (l[pc].oper == instruction::_LABEL or
+                                l[pc].oper == instruction::_NOOP)) ++pc;
+      if (pc >= l.size() or l[pc].oper != instruction::_UJUMP) return lab;
+      if (l[pc].arg1.str() == lab) return lab;
+      lab = l[pc].arg1.str();
+    }
+    return lab;
+  };
+
+  bool changed = false;
+  for (auto & ins : l) {
+    if (ins.oper == instruction::_UJUMP) {
+      string lab = final_label(ins.arg1.str());
+      if (lab != ins.arg1.str()) { ins.arg1 = lab; changed = true; }
+    }
+    else if (ins.oper == instruction::_FJUMP) {
+      string lab = final_label(ins.arg2.str());
+      if (lab != ins.arg2.str()) { ins.arg2 = lab; changed = true; }
+    }
+  }
+
+  // drop unconditional jumps whose label follows them directly
+  // (only labels and noops in between)
+  for (size_t k = l.size(); k-- > 0; ) {
+    if (l[k].oper != instruction::_UJUMP) continue;
+    auto it = labelpc.find(l[k].arg1.str());
+    if (it == labelpc.end() or it->second < k) continue;
+    bool fallsthrough = true;
+    for (size_t j = k+1; j < it->second; ++j)
+      if (l[j].oper != instruction::_LABEL and
+          l[j].oper != instruction::_NOOP) { fallsthrough = false; break; }
+    if (fallsthrough) {
+      l.erase(l.begin() + k);
+      // positions after k shift; recompute on the next iteration of
+      // the caller's fixpoint loop rather than patching the map here
+      changed = true;
+      break;
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////
+//
+//    peephole - local optimization of generated t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class peephole rewrites the instruction list of each subroutine
+/// with local simplifications, between code generation and output.
+/// The code generator materializes every subexpression into a fresh
+/// temporal and copies it around with LOADs; the passes here forward
+/// those copies, drop the temporals that become dead, and collapse
+/// chains of jumps. Only temporals created by the code generator
+/// (names starting with '%') are touched, so declared variables keep
+/// their values at every point.
+
+class peephole {
+public:
+  /// optimize every subroutine of the program, in place
+  static void optimize(code &c);
+
+  /// renumber the temporals of every subroutine so that a temporal
+  /// whose last use is past gives its number back (linear scan over
+  /// the appearance ranges, extended over backward jumps). Deep
+  /// expression trees then reuse a handful of temporals instead of
+  /// one frame slot each. Not run by default: the LLVM translator
+  /// requires singly-assigned temporals (see check_SSA_tCode)
+  static void recycle_temps(code &c);
+
+  /// fuse the element-by-element copy loop that the code generator
+  /// emits for a whole-array assignment into a single ACOPY
+  /// instruction, so the interpreter copies the array in one go and
+  /// the LLVM translator can emit a memcpy. Not run by default: the
+  /// textual dump would then contain an opcode external consumers of
+  /// the t-code do not know
+  static void fuse_array_copies(code &c);
+
+private:
+  /// run the passes over one subroutine until nothing changes
+  static void optimize_subroutine(subroutine &s);
+  /// drop the basic blocks that no control path reaches (collapsed
+  /// jumps often leave some behind); works on the subroutine itself,
+  /// since it needs the resolved branch targets (see cfg.h)
+  static bool remove_unreachable(subroutine &s);
+  /// renumber the temporals of one subroutine
+  static void recycle_subroutine(subroutine &s);
+  /// fuse the whole-array copy loops of one subroutine
+  static bool fuse_subroutine_copies(instructionList &l);
+
+  /// forward 'LOAD t,x' copies into the following uses of t inside
+  /// the basic block, while neither t nor x can change
+  static bool forward_copies(instructionList &l);
+  /// rewrite 't = a op b' followed by 'x = t' (t used only there)
+  /// into 'x = a op b'
+  static bool forward_results(instructionList &l);
+  /// remove side-effect-free instructions whose target temporal is
+  /// never read
+  static bool remove_dead_temporals(instructionList &l);
+  /// retarget jumps whose destination is another unconditional jump,
+  /// and remove jumps to the instruction that follows them
+  static bool collapse_jumps(instructionList &l);
+  /// fold operations whose sources hold known constants into a
+  /// single constant load, tracking constants within basic blocks
+  static bool fold_constants(instructionList &l);
+  /// reuse the result of an identical earlier computation in the
+  /// basic block (local common subexpression elimination; covers the
+  /// repeated array element and address fetches of a[i] = a[i] + 1)
+  static bool reuse_subexpressions(instructionList &l);
+
+  /// does this instruction write the temporal/variable in arg1?
+  static bool writes_arg1(const instruction &ins);
+  /// can this instruction be removed when its result is unused?
+  static bool is_pure(const instruction &ins);
+  /// does this instruction read the given name (in any operand)?
+  static bool reads(const instruction &ins, const std::string &name);
+  /// replace reads of 'from' with 'to' where it is safe to do so
+  /// (array base operands of XLOAD/LOADX are left untouched)
+  static bool replace_reads(instruction &ins, const std::string &from,
+                            const std::string &to);
+  /// is this the name of a code generator temporal?
+  static bool is_temp(const std::string &name);
+};
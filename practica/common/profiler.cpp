@@ -0,0 +1,130 @@
+/////////////////////////////////////////////////////////////////
+//
+//    profiler - per-phase timing and counters for the compiler
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <new>        // std::bad_alloc
+#include <cstdlib>    // std::malloc, std::free
+
+#include <sys/resource.h>   // getrusage
+
+#include "profiler.h"
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// allocation counting: replace the global operator new with the
+/// default malloc-based one plus a thread_local increment. The
+/// increment is unconditional (checking a flag would cost more than
+/// the counting), and the operators behave exactly like the default
+/// ones otherwise.
+
+void* operator new(std::size_t size) {
+  ++profiler::allocations;
+  void *p = std::malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](std::size_t size) {
+  ++profiler::allocations;
+  void *p = std::malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+
+////////////////////////////////////////////////////////////////////
+/// static attributes
+
+thread_local unsigned long profiler::symtableFinds       = 0;
+thread_local unsigned long profiler::decorationReads     = 0;
+thread_local unsigned long profiler::typesCreated        = 0;
+thread_local unsigned long profiler::instructionsEmitted = 0;
+thread_local unsigned long profiler::allocations         = 0;
+
+bool profiler::active = false;
+vector<profiler::phaseinfo> profiler::phases;
+string profiler::currentName;
+chrono::steady_clock::time_point profiler::currentStart;
+unsigned long profiler::currentAllocs = 0;
+
+
+void profiler::enable()  { active = true; }
+bool profiler::enabled() { return active; }
+
+long profiler::max_rss_kb() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+void profiler::phase_begin(const string &name) {
+  if (not active) return;
+  currentName   = name;
+  currentAllocs = allocations;
+  currentStart  = chrono::steady_clock::now();
+}
+
+void profiler::phase_end() {
+  if (not active or currentName.empty()) return;
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - currentStart;
+  phaseinfo ph;
+  ph.name     = currentName;
+  ph.wallms   = elapsed.count();
+  ph.allocs   = allocations - currentAllocs;
+  ph.maxrsskb = max_rss_kb();
+  phases.push_back(ph);
+  currentName.clear();
+}
+
+void profiler::report(ostream &os) {
+  if (not active) return;
+  os << "{ \"phases\": [";
+  bool first = true;
+  for (const phaseinfo &ph : phases) {
+    if (not first) os << ",";
+    first = false;
+    os << "\n    { \"name\": \"" << ph.name << "\""
+       << ", \"wall_ms\": " << ph.wallms
+       << ", \"allocations\": " << ph.allocs
+       << ", \"max_rss_kb\": " << ph.maxrsskb << " }";
+  }
+  os << " ],\n  \"counters\": {"
+     << " \"symtable_finds\": "       << symtableFinds
+     << ", \"decoration_reads\": "    << decorationReads
+     << ", \"types_created\": "       << typesCreated
+     << ", \"instructions_emitted\": " << instructionsEmitted
+     << ", \"total_allocations\": "   << allocations
+     << " } }" << endl;
+}
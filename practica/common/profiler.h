@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////
+//
+//    profiler - per-phase timing and counters for the compiler
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+////////////////////////////////////////////////////////////////////
+/// Class profiler gives a slow compile some visibility: the driver
+/// brackets each phase (parse, symbols, typecheck, codegen, ...) with
+/// phase_begin/phase_end, and report() prints one JSON object with
+/// the wall time, heap allocation count and peak resident size at
+/// the end of every phase, plus a few counters bumped from the hot
+/// spots of the compiler (symbol stack searches, tree decoration
+/// reads, created types, emitted instructions).
+/// The counters are thread_local and bumped unconditionally: an
+/// increment costs nothing measurable, so the instrumented functions
+/// pay no branch when profiling is off.
+
+class profiler {
+public:
+  /// turn profiling on (phase_begin/phase_end are no-ops otherwise)
+  static void enable();
+  static bool enabled();
+
+  /// mark the start / end of the named compilation phase
+  static void phase_begin(const std::string &name);
+  static void phase_end();
+
+  /// print everything recorded so far as one JSON object
+  static void report(std::ostream &os);
+
+  /// hot counters, incremented from the instrumented spots:
+  ///  - searches of an identifier along the scope stack
+  static thread_local unsigned long symtableFinds;
+  ///  - reads of the type decoration of a tree node (close to the
+  ///    number of nodes the visitors actually work on)
+  static thread_local unsigned long decorationReads;
+  ///  - compound types created (cache misses of the type tables)
+  static thread_local unsigned long typesCreated;
+  ///  - t-code instructions emitted
+  static thread_local unsigned long instructionsEmitted;
+  ///  - heap allocations (counted by the operator new replacement
+  ///    in profiler.cpp)
+  static thread_local unsigned long allocations;
+
+private:
+  /// what is recorded about one finished phase
+  struct phaseinfo {
+    std::string   name;
+    double        wallms;
+    unsigned long allocs;
+    long          maxrsskb;
+  };
+
+  static bool active;
+  static std::vector<phaseinfo> phases;
+  /// the phase currently open
+  static std::string currentName;
+  static std::chrono::steady_clock::time_point currentStart;
+  static unsigned long currentAllocs;
+
+  /// peak resident set size so far, in kilobytes
+  static long max_rss_kb();
+};
@@ -0,0 +1,350 @@
+/////////////////////////////////////////////////////////////////
+//
+//    tvm - in-process interpreter for t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#include "tvm.h"
+#include "iobuf.h"
+
+#include <algorithm>  // std::copy
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE, strtol, strtof
+
+using namespace std;
+
+
+////////////////////////////////////////////////////////////////////
+/// Implementation of class 'tvm'
+
+/// decode a character constant (the text between the quotes of a
+/// CHARVAL token, so possibly an escape sequence)
+static int decode_char(const string &s) {
+  if (s.size() == 2 and s[0] == '\\') {
+    switch (s[1]) {
+    case 'n':  return '\n';
+    case 't':  return '\t';
+    case '\\': return '\\';
+    case '\'': return '\'';
+    case '"':  return '"';
+    case '0':  return '\0';
+    }
+  }
+  return s.empty() ? '\0' : s[0];
+}
+
+/// constructor: index the subroutines by name, then decode each one
+tvm::tvm(const code &c) {
+  const vector<subroutine> & lsubs = c.get_subroutine_list();
+  mainsub = 0;
+  for (size_t i = 0; i < lsubs.size(); ++i)
+    if (lsubs[i].get_name() == "main") mainsub = i;
+  for (auto & s : lsubs)
+    load(s, c);
+}
+
+/// destructor
+tvm::~tvm() {}
+
+/// decode a string literal: strip the quotes and process the escape
+/// sequences once, so 'writes' is a plain output at run time
+int tvm::add_string(const string &s) {
+  string text;
+  size_t first = 0, last = s.size();
+  if (last >= 2 and (s[0] == '"' or s[0] == '\'')) { ++first; --last; }
+  for (size_t i = first; i < last; ++i) {
+    if (s[i] == '\\' and i+1 < last) {
+      text += char(decode_char(s.substr(i, 2)));
+      ++i;
+    }
+    else text += s[i];
+  }
+  strings.push_back(text);
+  return strings.size() - 1;
+}
+
+/// decode one subroutine: assign a frame slot to every parameter,
+/// local variable and temporal, and rewrite each instruction with
+/// its operands resolved (slots, immediates, label positions,
+/// subroutine indexes)
+void tvm::load(const subroutine &s, const code &c) {
+  dsub ds;
+  ds.name = s.get_name();
+
+  // frame layout: parameters first (they are the cells the caller
+  // pushed), then local variables (arrays take their full size),
+  // then any temporal found in the instructions
+  unordered_map<string, int> slots;
+  unordered_set<string> localarrays;
+  int next = 0;
+  for (auto & p : s.params)
+    slots[p.name] = next++;
+  ds.numparams = next;
+  for (auto & v : s.vars) {
+    slots[v.name] = next;
+    next += v.nelem;
+    if (v.nelem > 1 or v.type.find("array") != string::npos)
+      localarrays.insert(v.name);
+  }
+
+  // slot of a (possibly not yet seen) operand
+  auto slotof = [&slots, &next](const string &name) -> int {
+    auto it = slots.find(name);
+    if (it != slots.end()) return it->second;
+    slots[name] = next;
+    return next++;
+  };
+  // an indexed access is direct on a local array, and indirect when
+  // the operand holds an address (a by-reference array parameter, or
+  // a temporal where such an address was loaded)
+  auto isindirect = [&localarrays](const string &name) -> bool {
+    return localarrays.find(name) == localarrays.end();
+  };
+
+  const instructionList & linstr = s.get_instructions();
+  ds.instrs.reserve(linstr.size());
+  for (size_t pc = 0; pc < linstr.size(); ++pc) {
+    const instruction & ins = linstr[pc];
+    dinstr d;
+    d.op = ins.oper;
+    d.a1 = d.a2 = d.a3 = -1;
+    d.fimm = 0.0;
+    d.ind1 = d.ind2 = false;
+    switch (ins.oper) {
+    case instruction::_LABEL:
+    case instruction::_RETURN:
+    case instruction::_WRITELN:
+    case instruction::_NOOP:
+      break;
+    case instruction::_UJUMP:
+      d.a1 = s.get_branch_target(pc);
+      break;
+    case instruction::_FJUMP:
+      d.a1 = slotof(ins.arg1.str());
+      d.a2 = s.get_branch_target(pc);
+      break;
+    case instruction::_HALT:
+      d.a1 = add_string(ins.arg1.str());
+      break;
+    case instruction::_PUSH:
+    case instruction::_POP:
+      if (not ins.arg1.empty()) d.a1 = slotof(ins.arg1.str());
+      break;
+    case instruction::_CALL:
+      d.a1 = 0;
+      {
+        const vector<subroutine> & lsubs = c.get_subroutine_list();
+        for (size_t i = 0; i < lsubs.size(); ++i)
+          if (lsubs[i].get_name() == ins.arg1.str()) d.a1 = i;
+      }
+      break;
+    case instruction::_ILOAD:
+      d.a1 = slotof(ins.arg1.str());
+      d.a2 = std::strtol(ins.arg2.str().c_str(), nullptr, 10);
+      break;
+    case instruction::_CHLOAD:
+      d.a1 = slotof(ins.arg1.str());
+      d.a2 = decode_char(ins.arg2.str());
+      break;
+    case instruction::_FLOAD:
+      d.a1 = slotof(ins.arg1.str());
+      d.fimm = std::strtof(ins.arg2.str().c_str(), nullptr);
+      break;
+    case instruction::_XLOAD:
+      d.a1 = slotof(ins.arg1.str());
+      d.ind1 = isindirect(ins.arg1.str());
+      d.a2 = slotof(ins.arg2.str());
+      d.a3 = slotof(ins.arg3.str());
+      break;
+    case instruction::_LOADX:
+      d.a1 = slotof(ins.arg1.str());
+      d.a2 = slotof(ins.arg2.str());
+      d.ind1 = isindirect(ins.arg2.str());
+      d.a3 = slotof(ins.arg3.str());
+      break;
+    case instruction::_ACOPY:
+      d.a1 = slotof(ins.arg1.str());
+      d.ind1 = isindirect(ins.arg1.str());
+      d.a2 = slotof(ins.arg2.str());
+      d.ind2 = isindirect(ins.arg2.str());
+      d.a3 = std::strtol(ins.arg3.str().c_str(), nullptr, 10);
+      break;
+    case instruction::_WRITES:
+      d.a1 = add_string(ins.arg1.str());
+      break;
+    default:
+      // the remaining instructions take only variable/temporal
+      // operands: resolve whichever are present to their slots
+      if (not ins.arg1.empty()) d.a1 = slotof(ins.arg1.str());
+      if (not ins.arg2.empty()) d.a2 = slotof(ins.arg2.str());
+      if (not ins.arg3.empty()) d.a3 = slotof(ins.arg3.str());
+      break;
+    }
+    ds.instrs.push_back(d);
+  }
+  ds.framesize = next;
+  subs.push_back(ds);
+}
+
+/// run the decoded program starting at 'main'
+int tvm::run(istream &in, ostream &out) {
+  // the I/O opcodes go through block buffers with locale-free
+  // formatting instead of the stream operators (see iobuf.h);
+  // whatever is pending reaches 'out' when 'io' leaves scope
+  iobuf io(in, out);
+  vector<value>      stack;
+  vector<activation> calls;
+  size_t cs = mainsub;   // current subroutine
+  size_t pc = 0;         // program counter inside it
+  size_t fb = 0;         // base of the current frame in 'stack'
+  stack.resize(subs[cs].framesize);
+
+  while (true) {
+    // falling off the end of a subroutine behaves as 'return'
+    if (pc >= subs[cs].instrs.size()) {
+      if (calls.empty()) return EXIT_SUCCESS;
+      stack.resize(fb + subs[cs].numparams);
+      cs = calls.back().sub;  pc = calls.back().pc;  fb = calls.back().fb;
+      calls.pop_back();
+      continue;
+    }
+    const dinstr & i = subs[cs].instrs[pc++];
+    value *fp = stack.data() + fb;
+    switch (i.op) {
+
+    case instruction::_LABEL:
+    case instruction::_NOOP:
+      break;
+
+    case instruction::_UJUMP:
+      pc = i.a1;
+      break;
+    case instruction::_FJUMP:
+      if (not fp[i.a1].i) pc = i.a2;
+      break;
+    case instruction::_HALT:
+      io.flush();
+      if (not strings[i.a1].empty()) {
+        cerr << strings[i.a1] << endl;
+        return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+
+    case instruction::_PUSH:
+      stack.push_back(i.a1 >= 0 ? fp[i.a1] : value());
+      break;
+    case instruction::_POP:
+      if (i.a1 >= 0) fp[i.a1] = stack.back();
+      stack.pop_back();
+      break;
+    case instruction::_CALL: {
+      calls.push_back(activation{cs, pc, fb});
+      cs = i.a1;
+      fb = stack.size() - subs[cs].numparams;
+      stack.resize(fb + subs[cs].framesize);
+      pc = 0;
+      break;
+    }
+    case instruction::_RETURN:
+      if (calls.empty()) return EXIT_SUCCESS;
+      stack.resize(fb + subs[cs].numparams);
+      cs = calls.back().sub;  pc = calls.back().pc;  fb = calls.back().fb;
+      calls.pop_back();
+      break;
+
+    case instruction::_ADD:  fp[i.a1].i = fp[i.a2].i +   fp[i.a3].i; break;
+    case instruction::_SUB:  fp[i.a1].i = fp[i.a2].i -   fp[i.a3].i; break;
+    case instruction::_MUL:  fp[i.a1].i = fp[i.a2].i *   fp[i.a3].i; break;
+    case instruction::_DIV:  fp[i.a1].i = fp[i.a2].i /   fp[i.a3].i; break;
+    case instruction::_EQ:   fp[i.a1].i = fp[i.a2].i ==  fp[i.a3].i; break;
+    case instruction::_LT:   fp[i.a1].i = fp[i.a2].i <   fp[i.a3].i; break;
+    case instruction::_LE:   fp[i.a1].i = fp[i.a2].i <=  fp[i.a3].i; break;
+    case instruction::_AND:  fp[i.a1].i = fp[i.a2].i and fp[i.a3].i; break;
+    case instruction::_OR:   fp[i.a1].i = fp[i.a2].i or  fp[i.a3].i; break;
+    case instruction::_NOT:  fp[i.a1].i = not fp[i.a2].i;            break;
+    case instruction::_NEG:  fp[i.a1].i = - fp[i.a2].i;              break;
+
+    case instruction::_FADD: fp[i.a1].f = fp[i.a2].f +  fp[i.a3].f;  break;
+    case instruction::_FSUB: fp[i.a1].f = fp[i.a2].f -  fp[i.a3].f;  break;
+    case instruction::_FMUL: fp[i.a1].f = fp[i.a2].f *  fp[i.a3].f;  break;
+    case instruction::_FDIV: fp[i.a1].f = fp[i.a2].f /  fp[i.a3].f;  break;
+    case instruction::_FEQ:  fp[i.a1].i = fp[i.a2].f == fp[i.a3].f;  break;
+    case instruction::_FLT:  fp[i.a1].i = fp[i.a2].f <  fp[i.a3].f;  break;
+    case instruction::_FLE:  fp[i.a1].i = fp[i.a2].f <= fp[i.a3].f;  break;
+    case instruction::_FNEG: fp[i.a1].f = - fp[i.a2].f;              break;
+    case instruction::_FLOAT: fp[i.a1].f = float(fp[i.a2].i);        break;
+
+    case instruction::_LOAD:   fp[i.a1]   = fp[i.a2];   break;
+    case instruction::_ILOAD:
+    case instruction::_CHLOAD: fp[i.a1].i = i.a2;       break;
+    case instruction::_FLOAD:  fp[i.a1].f = i.fimm;     break;
+    case instruction::_ALOAD:  fp[i.a1].i = fb + i.a2;  break;
+    case instruction::_LOADC:  fp[i.a1] = stack[fp[i.a2].i];  break;
+    case instruction::_CLOAD:  stack[fp[i.a1].i] = fp[i.a2];  break;
+    case instruction::_XLOAD: {
+      size_t base = i.ind1 ? size_t(fp[i.a1].i) : fb + i.a1;
+      stack[base + fp[i.a2].i] = fp[i.a3];
+      break;
+    }
+    case instruction::_LOADX: {
+      size_t base = i.ind1 ? size_t(fp[i.a2].i) : fb + i.a2;
+      fp[i.a1] = stack[base + fp[i.a3].i];
+      break;
+    }
+    case instruction::_ACOPY: {
+      size_t dst = i.ind1 ? size_t(fp[i.a1].i) : fb + i.a1;
+      size_t src = i.ind2 ? size_t(fp[i.a2].i) : fb + i.a2;
+      std::copy(stack.begin() + src, stack.begin() + src + i.a3,
+                stack.begin() + dst);
+      break;
+    }
+
+    case instruction::_READI:  io.readi(fp[i.a1].i);       break;
+    case instruction::_READF:  io.readf(fp[i.a1].f);       break;
+    case instruction::_READC: {
+      char ch = '\0';
+      io.readc(ch);
+      fp[i.a1].i = ch;
+      break;
+    }
+    case instruction::_WRITEI: io.writei(fp[i.a1].i);      break;
+    case instruction::_WRITEF: io.writef(fp[i.a1].f);      break;
+    case instruction::_WRITEC: io.writec(char(fp[i.a1].i)); break;
+    case instruction::_WRITES: io.writes(strings[i.a1]);   break;
+    case instruction::_WRITELN: io.writeln();              break;
+
+    case instruction::_INVALID:
+      cerr << "tvm: invalid instruction at " << subs[cs].name
+           << ":" << pc-1 << endl;
+      return EXIT_FAILURE;
+    }
+  }
+}
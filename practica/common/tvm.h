@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////////////////////
+//
+//    tvm - in-process interpreter for t-code
+//
+//    Copyright (C) 2020-2030  Universitat Politecnica de Catalunya
+//
+//    This library is free software; you can redistribute it and/or
+//    modify it under the terms of the GNU General Public License
+//    as published by the Free Software Foundation; either version 3
+//    of the License, or (at your option) any later version.
+//
+//    This library is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//    Affero General Public License for more details.
+//
+//    You should have received a copy of the GNU Affero General Public
+//    License along with this library; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+//
+//    contact: Lluis Padro (padro@cs.upc.edu)
+//             Computer Science Department
+//             Universitat Politecnica de Catalunya
+//             despatx Omega.320 - Campus Nord UPC
+//             08034 Barcelona.  SPAIN
+//
+////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "code.h"
+
+
+////////////////////////////////////////////////////////////////////
+/// Class tvm executes the in-memory 'code' object produced by the
+/// code generator, so a program can be run without dumping the text
+/// form and re-parsing it in an external interpreter.
+/// The program is decoded once at load time: every operand string is
+/// resolved to a frame slot, an immediate value, a label position or
+/// a subroutine index, and execution then dispatches on a compact
+/// opcode with integer arguments only.
+
+class tvm {
+public:
+  /// constructor: decodes the given program (see load below)
+  tvm(const code &c);
+  /// destructor
+  ~tvm();
+
+  /// run the program, starting at subroutine 'main'.
+  /// Returns EXIT_SUCCESS, or EXIT_FAILURE after 'halt' with a message
+  int run(std::istream &in = std::cin, std::ostream &out = std::cout);
+
+private:
+  /// one memory/stack cell. Instructions are typed (ADD vs FADD,
+  /// ILOAD vs FLOAD...), so the active member is always known and
+  /// no tag is needed; characters and booleans live in 'i'
+  union value {
+    int   i;
+    float f;
+  };
+
+  /// one decoded instruction: the opcode plus up to three integer
+  /// arguments. Depending on the opcode an argument is a frame slot,
+  /// an immediate, a label position, a subroutine index or an index
+  /// into the decoded string table ('fimm' holds a float immediate).
+  /// 'ind1' and 'ind2' mark an array argument that holds an address
+  /// (a by-reference array parameter) rather than being a local array
+  /// itself ('ind2' is only used by acopy, whose two array arguments
+  /// are resolved independently)
+  struct dinstr {
+    instruction::Operation op;
+    int    a1, a2, a3;
+    float  fimm;
+    bool   ind1, ind2;
+  };
+
+  /// one decoded subroutine: its instructions, the size of its
+  /// activation frame and how many of its slots are parameters
+  /// (parameters are the top cells pushed by the caller, so a frame
+  /// is laid out as [params][local vars][temporals])
+  struct dsub {
+    std::string         name;
+    std::vector<dinstr> instrs;
+    std::size_t         numparams;
+    std::size_t         framesize;
+  };
+
+  /// one pending activation: where to resume when the callee returns
+  struct activation {
+    std::size_t sub;
+    std::size_t pc;
+    std::size_t fb;
+  };
+
+  /// decoded subroutines, and the index of 'main' in it
+  std::vector<dsub> subs;
+  std::size_t       mainsub;
+  /// decoded string literals ('writes' text, 'halt' messages)
+  std::vector<std::string> strings;
+
+  /// decode one subroutine of the program
+  void load(const subroutine &s, const code &c);
+  /// decode a string literal (strip quotes, process escapes) and
+  /// return its index in 'strings'
+  int add_string(const std::string &s);
+};